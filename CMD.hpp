@@ -8,6 +8,9 @@ constructor_args:
   - chassis_cmd_topic_name: "chassis_cmd"
   - gimbal_cmd_topic_name: "gimbal_cmd"
   - launcher_cmd_topic_name: "launcher_cmd"
+  - publish_period_ms: 0
+  - link_stats_topic_name: "cmd_link_stats"
+  - latency_topic_name: "cmd_latency"
 === END MANIFEST === */
 /* clang-format on */
 
@@ -17,20 +20,194 @@ constructor_args:
  * @details 负责处理来自不同控制源的命令，并将其转发到相应的执行单元
  */
 
+#include <algorithm>
 #include <array>
+#include <atomic>
+#include <bit>
 #include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <tuple>
+#include <type_traits>
 
 #include "app_framework.hpp"
+#include "crc.hpp"
 #include "event.hpp"
 #include "libxr_def.hpp"
 #include "message.hpp"
+#include "timebase.hpp"
+#include "timer.hpp"
 
 /**
- * @class CMD
- * @brief 控制命令处理类
- * @details 接收来自不同控制源的命令，处理并转发到底盘和云台等执行单元
+ * @brief 低内存配置，置1启用
+ * @details 数据快照改为发布流程中的栈上临时变量，可选功能默认关闭，
+ *          并在编译期检查 sizeof(CMD) 不超过 CMD_FOOTPRINT_BUDGET
+ */
+#ifndef CMD_LOW_FOOTPRINT
+#define CMD_LOW_FOOTPRINT 0
+#endif
+
+/**
+ * @brief 低内存配置下 sizeof(CMD) 的上限(字节)
+ * @details 32位目标实测约 684 字节，64位主机仿真放宽到 1024 字节
+ */
+#ifndef CMD_FOOTPRINT_BUDGET
+#define CMD_FOOTPRINT_BUDGET (sizeof(void*) == 4 ? 704 : 1024)
+#endif
+
+/**
+ * @brief 逐轴输入滤波，置0移除
+ */
+#ifndef CMD_INPUT_FILTER
+#define CMD_INPUT_FILTER (!CMD_LOW_FOOTPRINT)
+#endif
+
+/**
+ * @brief 上位机欧拉角主题，置0移除
+ * @details 见 CMD::EnableHostEulerTopic
+ */
+#ifndef CMD_HOST_EULER_TOPIC
+#define CMD_HOST_EULER_TOPIC (!CMD_LOW_FOOTPRINT)
+#endif
+
+/**
+ * @brief AI输入生产者数量
+ * @details 每个生产者独占一个输入槽，按通道归属合并，见 CMD::SetAIOwner
+ */
+#ifndef CMD_AI_PRODUCER_NUM
+#define CMD_AI_PRODUCER_NUM 1
+#endif
+
+/**
+ * @brief 完整命令帧附带命令元数据，置1启用
+ * @details 启用后 CMDFrame 末尾增加 CMDMeta，收发双方需使用相同配置
+ */
+#ifndef CMD_FRAME_META
+#define CMD_FRAME_META 0
+#endif
+
+/**
+ * @brief 锁相发布，置0移除
+ */
+#ifndef CMD_PHASE_LOCK
+#define CMD_PHASE_LOCK (!CMD_LOW_FOOTPRINT)
+#endif
+
+/**
+ * @brief 飞行记录仪，置1启用
+ * @details 输入、模式切换与发布结果写入预分配的环形缓冲区，见 CMD::Record
+ */
+#ifndef CMD_RECORDER
+#define CMD_RECORDER 0
+#endif
+
+/**
+ * @brief 飞行记录仪容量(条)，须为2的幂
+ */
+#ifndef CMD_RECORDER_SIZE
+#define CMD_RECORDER_SIZE 64
+#endif
+
+/**
+ * @brief 发布流程不变量检查，置1启用
+ * @details 用于仿真与浸泡测试，违反次数见 CMD::GetInvariantReport
+ */
+#ifndef CMD_INVARIANT_CHECK
+#define CMD_INVARIANT_CHECK 0
+#endif
+
+/**
+ * @brief 输入到发布时延统计，置1启用
+ * @details 关闭时统计相关的成员与代码全部移除
  */
-class CMD : public LibXR::Application {
+#ifndef CMD_LATENCY_STATS
+#define CMD_LATENCY_STATS 0
+#endif
+
+/**
+ * @brief 时延直方图首个桶的宽度为 2^CMD_LATENCY_BUCKET_SHIFT 个计时单位
+ */
+#ifndef CMD_LATENCY_BUCKET_SHIFT
+#define CMD_LATENCY_BUCKET_SHIFT 8
+#endif
+
+/**
+ * @brief 各输入链路统计，置0移除
+ */
+#ifndef CMD_LINK_STATS
+#define CMD_LINK_STATS (!CMD_LOW_FOOTPRINT)
+#endif
+
+/**
+ * @brief CMD 使用的控制策略
+ * @details 模块清单只能传递构造参数，需通过编译定义选择策略，例如
+ *          -DCMD_POLICY=CMDOpOnlyPolicy；也可直接使用 BasicCMD<Policy>
+ */
+#ifndef CMD_POLICY
+#define CMD_POLICY CMDAutoCapablePolicy
+#endif
+
+/**
+ * @brief 跨板CAN命令桥，置1启用
+ * @details 主控端将发布结果压缩为经典CAN帧发送，镜像端在本地重新发布，
+ *          见 CMD::EnableCANBridge
+ */
+#ifndef CMD_CAN_BRIDGE
+#define CMD_CAN_BRIDGE 0
+#endif
+
+#if CMD_CAN_BRIDGE
+#include "can.hpp"
+#endif
+
+/**
+ * @brief 定点命令帧主题，置1启用
+ * @details 见 CMD::EnableQuantizedTopic
+ */
+#ifndef CMD_QUANTIZED_TOPIC
+#define CMD_QUANTIZED_TOPIC 0
+#endif
+
+#if CMD_LATENCY_STATS
+#if defined(__ARM_ARCH_7M__) || defined(__ARM_ARCH_7EM__) || \
+    defined(__ARM_ARCH_8M_MAIN__)
+#define CMD_LATENCY_USE_DWT 1
+#else
+#include <chrono>
+#define CMD_LATENCY_USE_DWT 0
+#endif
+#endif
+
+/**
+ * @brief 控制器数据转换特性
+ * @tparam SourceDataType 控制源主题的数据类型
+ * @details 由各控制源模块特化，供 CMD::RegisterController 使用：
+ *          - `static constexpr CMD::ControlSource CTRL_SOURCE`：目标控制源
+ *          - `static constexpr CMD::RCInputSource RC_INPUT`：目标遥控输入源，
+ *            仅遥控控制源需要
+ *          - `static constexpr size_t AI_PRODUCER`：目标AI生产者，可选，默认0
+ *          - `static void Convert(const SourceDataType&, CMD::Data&)`：
+ *            直接写入 CMD 的输入槽
+ */
+template <typename SourceDataType>
+struct CMDControllerTraits;
+
+/**
+ * @brief 姿态数据转换特性
+ * @tparam SourceDataType IMU欧拉角主题的数据类型
+ * @details 由IMU模块特化，供 CMD::EnableHostEulerTopic 使用：
+ *          - `static void Convert(const SourceDataType&, CMD::HostEuler&)`：
+ *            写入 yaw/pit/rol，其余字段由 CMD 填写
+ */
+template <typename SourceDataType>
+struct CMDEulerTraits;
+
+/**
+ * @brief 控制命令公共类型
+ * @details 各策略的 BasicCMD 共用同一组命令与数据包类型，订阅者与控制源模块
+ *          通过 CMD::Data 等名称访问，与所选策略无关
+ */
+class CMDTypes {
  public:
   /**
    * @brief 控制源枚举
@@ -45,11 +222,76 @@ class CMD : public LibXR::Application {
    * @brief 遥控链路输入源枚举
    */
   enum class RCInputSource : uint8_t {
-    RC_INPUT_DR16,
-    RC_INPUT_VT13,
+    RC_INPUT_DR16,    /* DR16遥控器 */
+    RC_INPUT_VT13,    /* VT13遥控器 */
+    RC_INPUT_REFEREE, /* 裁判系统图传链路键鼠 */
     RC_INPUT_NUM
   };
 
+  /**
+   * @brief 遥控输入源优先级仲裁器
+   * @tparam Priority 参与仲裁的输入源，按优先级从高到低排列
+   * @details 在线状态以优先级序号为位保存在掩码中，选择时取最低置位，
+   *          与输入源数量无关
+   */
+  template <RCInputSource... Priority>
+  class RCArbiter {
+   public:
+    static constexpr size_t INPUT_NUM =
+        static_cast<size_t>(RCInputSource::RC_INPUT_NUM);
+    static constexpr size_t SOURCE_NUM = sizeof...(Priority);
+    static constexpr uint8_t NO_RANK = UINT8_MAX;
+
+    static_assert(SOURCE_NUM > 0 && SOURCE_NUM <= 32,
+                  "RCArbiter supports 1 to 32 sources");
+
+    /* 优先级 -> 输入源 */
+    static constexpr std::array<RCInputSource, SOURCE_NUM> ORDER = {
+        Priority...};
+
+    /* 输入源 -> 优先级，未参与仲裁的输入源为NO_RANK */
+    static constexpr std::array<uint8_t, INPUT_NUM> RANK = [] {
+      std::array<uint8_t, INPUT_NUM> rank{};
+      rank.fill(NO_RANK);
+      uint8_t next = 0;
+      ((rank[static_cast<size_t>(Priority)] = next++), ...);
+      return rank;
+    }();
+
+    /**
+     * @brief 输入源在在线掩码中的位
+     */
+    static constexpr uint32_t Bit(size_t index) {
+      return (index < INPUT_NUM && RANK[index] != NO_RANK)
+                 ? (1u << RANK[index])
+                 : 0u;
+    }
+
+    /**
+     * @brief 选择输入源
+     * @param online_mask 在线掩码
+     * @param active_index 当前活动输入源
+     * @return 活动源在线时保持不变，否则返回优先级最高的在线源；
+     *         全部离线时返回INPUT_NUM
+     */
+    static size_t Select(uint32_t online_mask, size_t active_index) {
+      if (online_mask & Bit(active_index)) {
+        return active_index;
+      }
+      if (online_mask == 0) {
+        return INPUT_NUM;
+      }
+      return static_cast<size_t>(ORDER[std::countr_zero(online_mask)]);
+    }
+  };
+
+  /**
+   * @brief 遥控输入源仲裁顺序
+   */
+  using RCInputArbiter =
+      RCArbiter<RCInputSource::RC_INPUT_DR16, RCInputSource::RC_INPUT_VT13,
+                RCInputSource::RC_INPUT_REFEREE>;
+
   /**
    * @brief 控制模式枚举
    */
@@ -111,254 +353,2879 @@ class CMD : public LibXR::Application {
     ControlSource ctrl_source; /* 控制源 */
   } Data;
 
+  /* 命令结构体即主题数据布局，尺寸或对齐变化会影响所有订阅者 */
+  static_assert(sizeof(GimbalCMD) == 9 * sizeof(float) &&
+                    alignof(GimbalCMD) == alignof(float),
+                "GimbalCMD layout changed");
+  static_assert(sizeof(ChassisCMD) == 4 * sizeof(float) &&
+                    alignof(ChassisCMD) == alignof(float),
+                "ChassisCMD layout changed");
+  static_assert(sizeof(LauncherCMD) == 1, "LauncherCMD layout changed");
+  static_assert(sizeof(Data) == 56 && alignof(Data) == alignof(float),
+                "Data layout changed");
+  static_assert(std::is_trivially_copyable_v<Data>,
+                "Data must stay trivially copyable for seqlock snapshots");
+  /* AI数据包按字段整段拷贝，依赖字段连续排列与小端字节序 */
+  static_assert(offsetof(GimbalCMD, rol) == 2 * sizeof(float) &&
+                    offsetof(GimbalCMD, rol_ddot) == 8 * sizeof(float) &&
+                    offsetof(ChassisCMD, z) == 2 * sizeof(float),
+                "AI packet field groups must be contiguous");
+  static_assert(std::endian::native == std::endian::little,
+                "AI packet layout is little-endian");
+
+#if CMD_FRAME_META
   /**
-   * @brief 控制事件ID
+   * @brief 命令元数据
+   * @details 时刻为本机时钟(us)，下游比较当前时刻与写入时刻即可拒绝或外推
+   *          过期命令，无需各自维护超时定时器；保活重发的命令写入时刻不变
    */
-  enum {
-    CMD_EVENT_START_CTRL = 0x13212508, /* 开始控制事件ID */
-    CMD_EVENT_LOST_CTRL = 0x13212509   /* 丢失控制事件ID */
-  };
+  typedef struct {
+    uint32_t chassis_arrival_us;  /* 底盘命令所用输入的写入时刻 */
+    uint32_t gimbal_arrival_us;   /* 云台命令所用输入的写入时刻 */
+    ControlSource chassis_source; /* 底盘命令的控制源 */
+    ControlSource gimbal_source;  /* 云台命令的控制源 */
+    RCInputSource rc_input;       /* 选中的遥控输入源，RC_INPUT_NUM 为无 */
+  } CMDMeta;
+#endif
 
   /**
-   * @brief 获取当前控制模式
-   * @return 当前控制模式
+   * @brief 完整命令帧
+   * @details 同一次发布中的三路命令与状态，供需要多路命令的下游一次读取
    */
-  Mode GetCtrlMode() { return this->mode_; }
+  typedef struct {
+    GimbalCMD gimbal;          /* 云台控制命令 */
+    ChassisCMD chassis;        /* 底盘控制命令 */
+    LauncherCMD launcher;      /* 发射控制命令 */
+    bool chassis_online;       /* 底盘命令是否来自在线源 */
+    bool gimbal_online;        /* 云台命令是否来自在线源 */
+    ControlSource ctrl_source; /* 本帧使用的控制源 */
+    uint32_t seq;              /* 命令帧序号 */
+#if CMD_FRAME_META
+    CMDMeta meta; /* 命令元数据 */
+#endif
+  } CMDFrame;
 
-  bool GetAIGimbalStatus() {
-    return this->data_[static_cast<size_t>(ControlSource::CTRL_SOURCE_AI)]
-        .gimbal_online;
-  }
+  /**
+   * @brief 定点底盘命令，字段为浮点值除以分辨率后取整
+   */
+  typedef struct {
+    int16_t x;            /* X轴方向控制量 */
+    int16_t y;            /* Y轴方向控制量 */
+    int16_t z;            /* Z轴方向控制量（旋转） */
+    ChasStat self_define; /* 自定义按钮 */
+  } QChassisCMD;
 
   /**
-   * @brief 获取CMD模块的事件处理器
-   * @return 事件处理器引用
-   * @details 用于其他模块绑定事件或激活事件
+   * @brief 定点云台命令，字段顺序与 GimbalCMD 相同
    */
-  LibXR::Event& GetEvent() { return cmd_event_; }
+  typedef struct {
+    int16_t yaw;
+    int16_t pit;
+    int16_t rol;
+    int16_t yaw_dot;
+    int16_t yaw_ddot;
+    int16_t pit_dot;
+    int16_t pit_ddot;
+    int16_t rol_dot;
+    int16_t rol_ddot;
+  } QGimbalCMD;
 
   /**
-   * @brief 获取在线状态
-   * @return 是否在线
+   * @brief 定点完整命令帧，供CAN/串口转发等带宽受限的下游订阅
    */
-  bool Online() { return this->online_; }
+  typedef struct {
+    QGimbalCMD gimbal;         /* 云台控制命令 */
+    QChassisCMD chassis;       /* 底盘控制命令 */
+    LauncherCMD launcher;      /* 发射控制命令 */
+    bool chassis_online;       /* 底盘命令是否来自在线源 */
+    bool gimbal_online;        /* 云台命令是否来自在线源 */
+    ControlSource ctrl_source; /* 本帧使用的控制源 */
+    uint16_t seq;              /* 命令帧序号 */
+  } QCMDFrame;
 
   /**
-   * @brief 直接写入遥控器控制数据
-   * @details 兼容接口，默认按DR16输入源写入
+   * @brief 上位机姿态反馈
+   * @details 按周期锁存的IMU欧拉角，附带锁存时云台通道AI命令的确认信息，
+   *          上位机可在同一个数据包中得到姿态与命令确认
    */
-  void FeedRC(const Data& rc_data) {
-    this->FeedRC(RCInputSource::RC_INPUT_DR16, rc_data);
-  }
+  typedef struct {
+    float yaw;           /* 偏航角 */
+    float pit;           /* 俯仰角 */
+    float rol;           /* 翻滚角 */
+    uint32_t sample_us;  /* 锁存时刻，本机时钟(us) */
+    uint32_t ai_seq;     /* 云台通道AI生产者已写入的命令数 */
+    uint32_t ai_host_us; /* 该生产者最近一条命令的上位机时间戳，未携带时为0 */
+  } HostEuler;
+
+  /* 定点命令按 int16 数组整段转换 */
+  static_assert(sizeof(QGimbalCMD) == 9 * sizeof(int16_t) &&
+                    sizeof(QChassisCMD) == 4 * sizeof(int16_t) &&
+                    sizeof(QCMDFrame) == 32,
+                "Quantized command layout changed");
 
   /**
-   * @brief 按遥控输入源写入控制数据
+   * @brief 定点分辨率，每个字段一项
+   * @details 定点值范围为 ±32767 个分辨率，超出时饱和
    */
-  void FeedRC(RCInputSource source, const Data& rc_data) {
-    const auto source_index = static_cast<size_t>(source);
-    if (source_index >= static_cast<size_t>(RCInputSource::RC_INPUT_NUM)) {
-      return;
-    }
+  struct QuantScale {
+    std::array<float, 3> chassis; /* 底盘 x/y/z */
+    std::array<float, 9> gimbal;  /* 云台各字段，顺序与 GimbalCMD 相同 */
+  };
 
-    this->rc_input_data_[source_index] = rc_data;
-    this->rc_input_seq_[source_index] = ++this->rc_update_seq_;
+  /**
+   * @brief 默认定点分辨率
+   * @details 底盘控制量与角度 1e-4 (±3.27)，角速度 1e-3，角加速度 1e-2
+   */
+  static constexpr QuantScale DEFAULT_QUANT_SCALE = {
+      {1e-4f, 1e-4f, 1e-4f},
+      {1e-4f, 1e-4f, 1e-4f, 1e-3f, 1e-2f, 1e-3f, 1e-2f, 1e-3f, 1e-2f}};
 
-    if (rc_data.chassis_online && this->IsRCInputActive(rc_data)) {
-      this->active_rc_input_ = source;
-    }
+  /**
+   * @brief AI紧凑数据包字段掩码
+   * @details 数据包格式（小端）：
+   *          | 偏移 | 长度 | 内容                                   |
+   *          | 0    | 1    | 帧头 AI_PACKET_HEADER                 |
+   *          | 1    | 1    | 字段掩码，按位取值见本枚举            |
+   *          | 2    | 1    | bit0 chassis_online，bit1 gimbal_online |
+   *          | 3    | N    | 按掩码位从低到高依次排列的字段        |
+   *          | 3+N  | 2    | 此前所有字节的 LibXR::CRC16           |
+   *          未出现的字段保持AI输入槽中的原值
+   */
+  enum AIPacketField : uint8_t {
+    AI_FIELD_GIMBAL_ANGLE = 1u << 0, /* yaw/pit/rol，3个float */
+    AI_FIELD_GIMBAL_DERIV = 1u << 1, /* yaw_dot至rol_ddot，6个float */
+    AI_FIELD_CHASSIS = 1u << 2,      /* x/y/z 3个float与self_define 1字节 */
+    AI_FIELD_LAUNCHER = 1u << 3,     /* isfire，1字节 */
+    AI_FIELD_TIMESTAMP = 1u << 4,    /* 上位机采集时刻(us)，uint32 */
+    AI_FIELD_ALL = 0x1f
+  };
+
+  static constexpr uint8_t AI_PACKET_HEADER = 0xa5;
 
-    this->ProcessAndPublish();
+  /**
+   * @brief 计算给定字段掩码的AI数据包长度
+   */
+  static constexpr size_t AIPacketSize(uint8_t fields) {
+    constexpr size_t AI_PACKET_OVERHEAD = 3 + sizeof(uint16_t);
+    return AI_PACKET_OVERHEAD +
+           ((fields & AI_FIELD_GIMBAL_ANGLE) ? 3 * sizeof(float) : 0) +
+           ((fields & AI_FIELD_GIMBAL_DERIV) ? 6 * sizeof(float) : 0) +
+           ((fields & AI_FIELD_CHASSIS) ? 3 * sizeof(float) + 1 : 0) +
+           ((fields & AI_FIELD_LAUNCHER) ? 1 : 0) +
+           ((fields & AI_FIELD_TIMESTAMP) ? sizeof(uint32_t) : 0);
   }
 
   /**
-   * @brief 直接写入 AI 控制数据
+   * @brief 云台命令转为定点形式
+   * @details 全部字段在一个无分支循环中转换，-O3 -fno-trapping-math 下
+   *          编译器可将其向量化
    */
-  void FeedAI(const Data& ai_data) {
-    this->data_[static_cast<size_t>(ControlSource::CTRL_SOURCE_AI)] = ai_data;
-    this->ProcessAndPublish();
+  static QGimbalCMD EncodeGimbal(
+      const GimbalCMD& gimbal,
+      const QuantScale& scale = DEFAULT_QUANT_SCALE) {
+    QGimbalCMD out;
+    QuantizeFields(gimbal, scale.gimbal, out);
+    return out;
   }
 
   /**
-   * @brief CMD构造函数
-   * @param hw 硬件容器引用
-   * @param app 应用管理器引用
-   * @param mode 控制模式，默认为操作员控制模式
-   * @param chassis_cmd_topic_name 底盘命令主题名称
-   * @param gimbal_cmd_topic_name 云台命令主题名称
+   * @brief 定点云台命令还原为浮点形式
    */
-  CMD(LibXR::HardwareContainer& hw, LibXR::ApplicationManager& app, Mode mode,
-      const char* chassis_cmd_topic_name, const char* gimbal_cmd_topic_name,
-      const char* launcher_cmd_topic_name)
-      : mode_(mode),
-        chassis_data_tp_(chassis_cmd_topic_name, sizeof(ChassisCMD), nullptr,
-                         true),
-        gimbal_data_tp_(gimbal_cmd_topic_name, sizeof(GimbalCMD), nullptr,
-                        true),
-        fire_data_tp_(launcher_cmd_topic_name, sizeof(LauncherCMD), nullptr,
-                      true) {
-    UNUSED(hw);
-    UNUSED(app);
-    /* 创建事件回调函数 */
-    auto callback = LibXR::Callback<uint32_t>::Create(
-        [](bool in_isr, CMD* cmd, uint32_t event_id) {
-          UNUSED(in_isr);
-          cmd->EventHandler(event_id);
-        },
-        this);
-    /* 注册控制模式事件处理回调 */
-    this->cmd_event_.Register(static_cast<uint32_t>(Mode::CMD_OP_CTRL),
-                              callback);
-    this->cmd_event_.Register(static_cast<uint32_t>(Mode::CMD_AUTO_CTRL),
-                              callback);
+  static GimbalCMD DecodeGimbal(const QGimbalCMD& gimbal,
+                                const QuantScale& scale = DEFAULT_QUANT_SCALE) {
+    GimbalCMD out;
+    DequantizeFields(gimbal, scale.gimbal, out);
+    return out;
   }
 
   /**
-   * @brief 设置控制模式
-   * @param mode 要设置的控制模式
-   * @details 根据不同的控制模式配置相应的数据处理回调函数
+   * @brief 底盘命令转为定点形式
    */
-  void SetCtrlMode(Mode mode) { this->mode_ = mode; }
+  static QChassisCMD EncodeChassis(
+      const ChassisCMD& chassis,
+      const QuantScale& scale = DEFAULT_QUANT_SCALE) {
+    QChassisCMD out;
+    QuantizeFields(chassis, scale.chassis, out);
+    out.self_define = chassis.self_define;
+    return out;
+  }
 
   /**
-   * @brief 事件处理器
-   * @param event_id 事件ID
-   * @details 处理来自事件系统的控制模式切换请求
+   * @brief 定点底盘命令还原为浮点形式
    */
-  void EventHandler(uint32_t event_id) {
-    this->SetCtrlMode(static_cast<Mode>(event_id));
+  static ChassisCMD DecodeChassis(
+      const QChassisCMD& chassis,
+      const QuantScale& scale = DEFAULT_QUANT_SCALE) {
+    ChassisCMD out;
+    DequantizeFields(chassis, scale.chassis, out);
+    out.self_define = chassis.self_define;
+    return out;
   }
 
   /**
-   * @brief 注册控制器
-   * @tparam SourceDataType 源数据类型
-   * @param source 源主题
-   * @details 将外部控制源的数据接入CMD系统，并进行预处理和分发
+   * @brief 完整命令帧转为定点形式，序号取低16位
    */
-  template <typename SourceDataType>
-  void RegisterController(LibXR::Topic& source) {
-    UNUSED(source);
+  static QCMDFrame EncodeFrame(const CMDFrame& frame,
+                               const QuantScale& scale = DEFAULT_QUANT_SCALE) {
+    return {EncodeGimbal(frame.gimbal, scale),
+            EncodeChassis(frame.chassis, scale),
+            frame.launcher,
+            frame.chassis_online,
+            frame.gimbal_online,
+            frame.ctrl_source,
+            static_cast<uint16_t>(frame.seq)};
   }
 
   /**
-   * @brief 监控函数重写
+   * @brief 定点命令帧还原为完整命令帧
    */
-  void OnMonitor() override {}
+  static CMDFrame DecodeFrame(const QCMDFrame& frame,
+                              const QuantScale& scale = DEFAULT_QUANT_SCALE) {
+    CMDFrame out{};
+    out.gimbal = DecodeGimbal(frame.gimbal, scale);
+    out.chassis = DecodeChassis(frame.chassis, scale);
+    out.launcher = frame.launcher;
+    out.chassis_online = frame.chassis_online;
+    out.gimbal_online = frame.gimbal_online;
+    out.ctrl_source = frame.ctrl_source;
+    out.seq = frame.seq;
+    return out;
+  }
 
  private:
-  bool online_ = false;    /* 在线状态 */
-  Mode mode_;              /* 当前控制模式 */
-  LibXR::Event cmd_event_; /* 事件处理器 */
-  std::array<Data, static_cast<size_t>(ControlSource::CTRL_SOURCE_NUM)>
-      data_{}; /* 各控制源的数据 */
-  std::array<Data, static_cast<size_t>(RCInputSource::RC_INPUT_NUM)>
-      rc_input_data_{}; /* 各遥控输入源的数据 */
-  std::array<uint32_t, static_cast<size_t>(RCInputSource::RC_INPUT_NUM)>
-      rc_input_seq_{};              /* 各遥控输入源的数据序号 */
-  LibXR::Topic chassis_data_tp_;    /* 底盘命令主题 */
-  LibXR::Topic gimbal_data_tp_;     /* 云台命令主题 */
-  LibXR::Topic fire_data_tp_;       /* 开火命令主题 */
-  LibXR::Topic host_euler_data_tp_; /* 上位机欧拉角主题 */
-  RCInputSource active_rc_input_ =
-      RCInputSource::RC_INPUT_DR16; /* 当前活动遥控输入源 */
-  uint32_t rc_update_seq_ = 0;      /* 遥控输入数据更新序号 */
+  /* 浮点命令与定点命令均按字段数组整段转换，NaN 转为0 */
+  template <typename Float, typename Fixed, size_t N>
+  static void QuantizeFields(const Float& in, const std::array<float, N>& scale,
+                             Fixed& out) {
+    static_assert(sizeof(Float) >= N * sizeof(float) &&
+                  sizeof(Fixed) >= N * sizeof(int16_t));
+    std::array<float, N> value;
+    std::array<int16_t, N> fixed;
+    std::memcpy(value.data(), &in, sizeof(value));
+    for (size_t i = 0; i < N; i++) {
+      float q = value[i] / scale[i];
+      q = (q == q) ? q : 0.0f;
+      q = q > -32767.0f ? q : -32767.0f;
+      q = q < 32767.0f ? q : 32767.0f;
+      fixed[i] = static_cast<int16_t>(q + (q >= 0.0f ? 0.5f : -0.5f));
+    }
+    std::memcpy(&out, fixed.data(), sizeof(fixed));
+  }
 
-  /*--------------------------工具函数-------------------------------------------------*/
-  static bool IsRCInputOnline(const Data& rc_data) {
-    return rc_data.chassis_online;
+  template <typename Fixed, typename Float, size_t N>
+  static void DequantizeFields(const Fixed& in,
+                               const std::array<float, N>& scale, Float& out) {
+    std::array<int16_t, N> fixed;
+    std::array<float, N> value;
+    std::memcpy(fixed.data(), &in, sizeof(fixed));
+    for (size_t i = 0; i < N; i++) {
+      value[i] = static_cast<float>(fixed[i]) * scale[i];
+    }
+    std::memcpy(&out, value.data(), sizeof(value));
   }
+};
 
-  static bool IsRCInputActive(const Data& rc_data) {
-    constexpr float RC_ACTIVITY_EPS = 0.05f;
+/**
+ * @brief 可在运行时切换到 CMD_AUTO_CTRL 的策略
+ */
+struct CMDAutoCapablePolicy {
+  static constexpr bool AUTO_CTRL = true; /* 是否保留AI控制源 */
+};
+
+/**
+ * @brief 只使用 CMD_OP_CTRL 的策略
+ * @details 编译期移除AI输入槽、AI快照与自动模式分支；控制模式固定为
+ *          CMD_OP_CTRL，AI写入被忽略，FeedAIPacket 返回 ARG_ERR
+ */
+struct CMDOpOnlyPolicy {
+  static constexpr bool AUTO_CTRL = false; /* 是否保留AI控制源 */
+};
+
+/**
+ * @class BasicCMD
+ * @brief 控制命令处理类
+ * @tparam Policy 控制策略，CMDAutoCapablePolicy 或 CMDOpOnlyPolicy
+ * @details 接收来自不同控制源的命令，处理并转发到底盘和云台等执行单元
+ */
+template <typename Policy>
+class BasicCMD : public LibXR::Application, public CMDTypes {
+ public:
+  /* AI生产者数量，CMDOpOnlyPolicy 下为0 */
+  static constexpr size_t AI_PRODUCER_NUM =
+      Policy::AUTO_CTRL ? CMD_AI_PRODUCER_NUM : 0;
+
+  /**
+   * @brief 发布计数
+   */
+  struct PublishCounters {
+    uint32_t feeds;     /* 输入写入次数 */
+    uint32_t process;   /* 汇总发布流程执行次数 */
+    uint32_t aborted;   /* 快照读取被打断而放弃的次数 */
+    uint32_t published; /* 实际 Publish 调用次数 */
+    uint32_t skipped;   /* 变化检测跳过的 Publish 次数 */
+  };
 
-    return std::fabs(rc_data.chassis.x) > RC_ACTIVITY_EPS ||
-           std::fabs(rc_data.chassis.y) > RC_ACTIVITY_EPS ||
-           std::fabs(rc_data.chassis.z) > RC_ACTIVITY_EPS ||
-           std::fabs(rc_data.gimbal.yaw) > RC_ACTIVITY_EPS ||
-           std::fabs(rc_data.gimbal.pit) > RC_ACTIVITY_EPS ||
-           std::fabs(rc_data.gimbal.rol) > RC_ACTIVITY_EPS ||
-           (rc_data.chassis.self_define != ChasStat::NONE) ||
-           rc_data.launcher.isfire;
+  /**
+   * @brief 获取发布计数
+   * @details 供性能评估使用，两次读取的差值除以间隔即为各项速率
+   */
+  PublishCounters GetPublishCounters() const {
+    PublishCounters counters = this->counters_;
+    counters.feeds = this->rc_update_seq_.load(std::memory_order_relaxed);
+    for (const AIInput& ai : this->ai_input_) {
+      counters.feeds += ai.seq.load(std::memory_order_relaxed) / 2;
+    }
+    return counters;
   }
 
-  static Data MakeOfflineRCData() {
-    Data rc_data{};
-    rc_data.chassis_online = false;
-    rc_data.gimbal_online = false;
-    rc_data.ctrl_source = ControlSource::CTRL_SOURCE_RC;
-    return rc_data;
+#if CMD_PHASE_LOCK
+  /**
+   * @brief 锁相发布统计
+   * @details 相位误差为触发到本次发布完成的时间，超过领先量即晚于下游读取
+   */
+  struct PhaseStats {
+    uint32_t ticks;         /* 触发次数 */
+    uint32_t period_us;     /* 触发周期估计 */
+    uint32_t max_jitter_us; /* 触发间隔与周期估计的最大偏差 */
+    uint32_t last_error_us; /* 最近一次相位误差 */
+    uint32_t mean_error_us; /* 相位误差滑动平均 */
+    uint32_t max_error_us;  /* 最大相位误差 */
+    uint32_t late;          /* 相位误差超过领先量的次数 */
+  };
+
+  /**
+   * @brief 获取锁相发布统计
+   */
+  const PhaseStats& GetPhaseStats() const { return this->phase_stats_; }
+#endif
+
+#if CMD_INVARIANT_CHECK
+  /**
+   * @brief 发布流程不变量
+   */
+  enum Invariant : uint32_t {
+    INVARIANT_AUTO_FIRE = 1u << 0,     /* 自动模式下开火需遥控与在线AI同时请求 */
+    INVARIANT_AI_SOURCE = 1u << 1,     /* AI命令只在自动模式且AI在线时输出 */
+    INVARIANT_RC_SOURCE = 1u << 2,     /* 遥控命令只来自在线的遥控输入源 */
+    INVARIANT_ONLINE_STATE = 1u << 3,  /* 防抖结束后在线状态与遥控输入一致 */
+  };
+
+  /**
+   * @brief 不变量检查报告
+   */
+  struct InvariantReport {
+    uint32_t checks;       /* 检查次数，即完成快照读取的发布流程次数 */
+    uint32_t violations;   /* 违反次数 */
+    uint32_t failed_mask;  /* 曾违反的不变量，按位取值见 Invariant */
+    uint32_t last_process; /* 最近一次违反时的流程序号，见 PublishCounters */
+  };
+
+  /**
+   * @brief 获取不变量检查报告
+   * @details 仿真中每批输入后检查 violations 为0即可
+   */
+  const InvariantReport& GetInvariantReport() const {
+    return this->invariant_report_;
   }
+#endif
 
-  Data SelectRCData() {
-    const auto dr16_index = static_cast<size_t>(RCInputSource::RC_INPUT_DR16);
-    const auto vt13_index = static_cast<size_t>(RCInputSource::RC_INPUT_VT13);
-    const auto active_index = static_cast<size_t>(this->active_rc_input_);
+#if CMD_LINK_STATS
+  /**
+   * @brief 单条输入链路统计
+   */
+  struct LinkStats {
+    uint32_t frames;     /* 累计帧数 */
+    float rate_hz;       /* 最近统计周期内的帧率 */
+    uint32_t max_gap_us; /* 最大帧间隔 */
+    uint32_t offline_ms; /* 累计离线时间 */
+  };
 
-    /* 当前活动源在线则持续使用 */
-    if (active_index < static_cast<size_t>(RCInputSource::RC_INPUT_NUM) &&
-        this->IsRCInputOnline(this->rc_input_data_[active_index])) {
-      return this->rc_input_data_[active_index];
-    }
+  /**
+   * @brief 输入链路统计报告
+   */
+  struct LinkReport {
+    std::array<LinkStats, static_cast<size_t>(RCInputSource::RC_INPUT_NUM)>
+        rc;                                         /* 各遥控输入源 */
+    std::array<LinkStats, AI_PRODUCER_NUM> ai; /* 各AI生产者 */
+    uint32_t failover_count; /* 遥控输入源切换次数 */
+  };
 
-    /* 活动源离线后切换 */
-    if (this->active_rc_input_ == RCInputSource::RC_INPUT_DR16) {
-      if (this->IsRCInputOnline(this->rc_input_data_[vt13_index])) {
-        this->active_rc_input_ = RCInputSource::RC_INPUT_VT13;
-        return this->rc_input_data_[vt13_index];
-      }
-      if (this->IsRCInputOnline(this->rc_input_data_[dr16_index])) {
-        this->active_rc_input_ = RCInputSource::RC_INPUT_DR16;
-        return this->rc_input_data_[dr16_index];
-      }
-    } else {
-      if (this->IsRCInputOnline(this->rc_input_data_[dr16_index])) {
-        this->active_rc_input_ = RCInputSource::RC_INPUT_DR16;
-        return this->rc_input_data_[dr16_index];
-      }
-      if (this->IsRCInputOnline(this->rc_input_data_[vt13_index])) {
-        this->active_rc_input_ = RCInputSource::RC_INPUT_VT13;
-        return this->rc_input_data_[vt13_index];
-      }
-    }
+  /**
+   * @brief 获取输入链路统计
+   * @details 帧率与离线时间在 OnMonitor 中按统计周期更新
+   */
+  const LinkReport& GetLinkStats() const { return this->link_report_; }
 
-    return MakeOfflineRCData();
+  /**
+   * @brief 设置输入链路统计的更新与发布周期
+   * @param period_ms 统计周期(ms)
+   * @details 每个周期在 OnMonitor 中更新一次统计并发布链路统计主题
+   */
+  void SetLinkStatsPeriod(uint32_t period_ms) {
+    this->link_stats_period_us_ = period_ms * 1000;
   }
+#endif
 
-  void ProcessAndPublish() {
-    const Data rc_data = this->SelectRCData();
-    const Data& ai_data =
-        this->data_[static_cast<size_t>(ControlSource::CTRL_SOURCE_AI)];
+#if CMD_LATENCY_STATS
+  /**
+   * @brief 时延统计
+   * @details 计时单位在 Cortex-M 上为 DWT 周期数，在其他平台上为纳秒；
+   *          histogram[i] 统计 [2^(i+SHIFT-1), 2^(i+SHIFT)) 区间，首尾桶开放
+   */
+  struct LatencyStats {
+    static constexpr size_t BUCKET_NUM = 8;
 
-    this->data_[static_cast<size_t>(ControlSource::CTRL_SOURCE_RC)] = rc_data;
+    uint32_t min = UINT32_MAX; /* 最小值 */
+    uint32_t max = 0;          /* 最大值 */
+    uint64_t sum = 0;          /* 累计值 */
+    uint32_t count = 0;        /* 样本数 */
+    std::array<uint32_t, BUCKET_NUM> histogram{}; /* 分桶计数 */
 
-    if (!rc_data.chassis_online && this->online_) {
-      this->cmd_event_.Active(CMD_EVENT_LOST_CTRL);
-      this->online_ = false;
-    } else if (rc_data.chassis_online && !this->online_) {
-      this->cmd_event_.Active(CMD_EVENT_START_CTRL);
-      this->online_ = true;
+    uint32_t Mean() const {
+      return this->count ? static_cast<uint32_t>(this->sum / this->count) : 0;
     }
 
-    if (this->mode_ == Mode::CMD_OP_CTRL) {
-      Data out = rc_data;
-      this->gimbal_data_tp_.Publish(out.gimbal);
-      this->chassis_data_tp_.Publish(out.chassis);
-      this->fire_data_tp_.Publish(out.launcher);
-    } else {
-      /* CMD_AUTO_CTRL */
-      ChassisCMD out_chassis =
-          ai_data.chassis_online ? ai_data.chassis : rc_data.chassis;
-      GimbalCMD out_gimbal =
-          ai_data.gimbal_online ? ai_data.gimbal : rc_data.gimbal;
-      LauncherCMD out_launcher;
-      out_launcher.isfire =
-          (ai_data.launcher.isfire && rc_data.launcher.isfire);
-
-      ChassisCMD chassis = out_chassis;
-      GimbalCMD gimbal = out_gimbal;
-      LauncherCMD launcher = out_launcher;
-      this->gimbal_data_tp_.Publish(gimbal);
-      this->chassis_data_tp_.Publish(chassis);
-      this->fire_data_tp_.Publish(launcher);
+    void Record(uint32_t ticks) {
+      this->min = ticks < this->min ? ticks : this->min;
+      this->max = ticks > this->max ? ticks : this->max;
+      this->sum += ticks;
+      this->count++;
+      const size_t bucket = static_cast<size_t>(
+          std::bit_width(ticks >> CMD_LATENCY_BUCKET_SHIFT));
+      this->histogram[bucket < BUCKET_NUM ? bucket : BUCKET_NUM - 1]++;
     }
-  }
-};
+  };
+
+  /**
+   * @brief 时延统计报告
+   */
+  struct LatencyReport {
+    std::array<LatencyStats, static_cast<size_t>(RCInputSource::RC_INPUT_NUM)>
+        rc_feed_to_publish; /* 各遥控输入源从写入到发布完成的时延 */
+    std::array<LatencyStats, AI_PRODUCER_NUM>
+        ai_feed_to_publish; /* 各AI生产者从写入到发布完成的时延 */
+    LatencyStats process;   /* ProcessAndPublish 总耗时 */
+    LatencyStats publish;   /* 三路 Publish 耗时 */
+  };
+
+  /**
+   * @brief 获取时延统计
+   * @details 仅用于诊断，与发布流程并发读取时可能不完全一致
+   */
+  const LatencyReport& GetLatencyStats() const { return this->latency_; }
+
+  /**
+   * @brief 清空时延统计
+   */
+  void ResetLatencyStats() { this->latency_ = LatencyReport{}; }
+#endif
+
+#if CMD_RECORDER
+  static_assert(std::has_single_bit(static_cast<uint32_t>(CMD_RECORDER_SIZE)),
+                "CMD_RECORDER_SIZE must be a power of two");
+
+  /**
+   * @brief 记录类型
+   */
+  enum class RecordType : uint8_t {
+    FEED_RC,      /* 遥控输入，arg为输入源，data为写入后的输入槽 */
+    FEED_AI,      /* AI输入，arg为生产者，aux为本机采集时刻，data为输入槽 */
+    MODE,         /* 模式切换，arg为新模式 */
+    PUBLISH,      /* 发布结果，arg为选中的遥控输入源，aux为流程序号 */
+    ESTOP,        /* 紧急停止 */
+    ESTOP_RELEASE /* 解除紧急停止 */
+  };
+
+  /**
+   * @brief 飞行记录
+   * @details PUBLISH 记录的 data 为本次发布的三路命令与在线状态，选中的遥控
+   *          输入源为 RC_INPUT_NUM 表示无在线遥控输入源
+   */
+  struct Record {
+    uint32_t time_us; /* 记录时刻 */
+    uint32_t aux;     /* 附加数据，含义见 RecordType */
+    RecordType type;  /* 记录类型 */
+    uint8_t arg;      /* 附加参数，含义见 RecordType */
+    uint16_t index;   /* 记录序号低16位，用于检查导出的记录流是否连续 */
+    Data data;        /* 输入或输出数据 */
+  };
+
+  /**
+   * @brief 导出飞行记录
+   * @param out 输出缓冲区
+   * @param max_count 输出缓冲区容量(条)
+   * @return 导出的记录条数
+   * @details 只允许一个导出者，可在后台任务中调用后写入 Flash 或串口；
+   *          导出不及时被覆盖的记录计入 GetRecorderDropped
+   */
+  size_t DrainRecords(Record* out, size_t max_count) {
+    size_t count = 0;
+    while (count < max_count) {
+      const uint32_t head = this->record_head_.load(std::memory_order_acquire);
+      if (head - this->record_tail_ > CMD_RECORDER_SIZE) {
+        this->record_dropped_ += head - this->record_tail_ - CMD_RECORDER_SIZE;
+        this->record_tail_ = head - CMD_RECORDER_SIZE;
+      }
+      if (this->record_tail_ == head) {
+        break;
+      }
+
+      /* 写入者尚未提交时停止，读取期间被覆盖时按新的写位置跳过 */
+      const uint32_t slot = this->record_tail_ % CMD_RECORDER_SIZE;
+      const uint32_t commit = this->record_tail_ + 1;
+      if (this->record_commit_[slot].load(std::memory_order_acquire) !=
+          commit) {
+        break;
+      }
+      out[count] = this->record_ring_[slot];
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (this->record_commit_[slot].load(std::memory_order_relaxed) !=
+          commit) {
+        continue;
+      }
+      this->record_tail_++;
+      count++;
+    }
+    return count;
+  }
+
+  /**
+   * @brief 获取因导出不及时被覆盖的记录条数
+   */
+  uint32_t GetRecorderDropped() const { return this->record_dropped_; }
+
+  /**
+   * @brief 回放一条飞行记录
+   * @param record 由 DrainRecords 导出的记录
+   * @details 以记录时刻作为本实例的时钟，按原顺序重新写入输入、模式切换与
+   *          紧急停止。回放中由前面的记录触发的发布与随后同样数量的 PUBLISH
+   *          记录对应，其余 PUBLISH 记录来自定频节拍、输入超时或在线边沿
+   *          防抖结束，依次驱动 PublishTick（仅定频模式）或输入超时检查，
+   *          未发布时再检查防抖；定时任务不再发布（见 SetExternalTick）。
+   *          回放不依赖真实时间，可在主机上以任意速度运行，本实例产生的
+   *          PUBLISH 记录即为复现的发布结果
+   */
+  void Replay(const Record& record) {
+    this->replay_now_us_ = record.time_us;
+    this->SetClock(ReplayClock, this);
+    this->SetExternalTick(true);
+
+    if (record.type == RecordType::PUBLISH && this->replay_published_ > 0) {
+      this->replay_published_--;
+      return;
+    }
+
+    const uint32_t published_before =
+        this->counters_.process - this->counters_.aborted;
+    switch (record.type) {
+      case RecordType::FEED_RC:
+        this->FeedRC(static_cast<RCInputSource>(record.arg), record.data);
+        break;
+      case RecordType::FEED_AI:
+        this->WriteAIInput(
+            record.arg, [&](Data& slot) { slot = record.data; },
+            record.time_us, record.aux);
+        break;
+      case RecordType::MODE:
+        this->SetCtrlMode(static_cast<Mode>(record.arg));
+        break;
+      case RecordType::PUBLISH:
+        if (this->publish_period_ms_ > 0 || this->phase_locked_) {
+          this->PublishTick();
+        } else {
+          this->CheckStale();
+        }
+        if (this->counters_.process - this->counters_.aborted ==
+            published_before) {
+          this->CheckEventDwell();
+        }
+        break;
+      case RecordType::ESTOP:
+        this->EmergencyStop();
+        break;
+      case RecordType::ESTOP_RELEASE:
+        this->ReleaseEmergencyStop();
+        break;
+    }
+
+    /* PUBLISH 记录自身对应其触发的第一次发布 */
+    this->replay_published_ +=
+        this->counters_.process - this->counters_.aborted - published_before;
+    if (record.type == RecordType::PUBLISH && this->replay_published_ > 0) {
+      this->replay_published_--;
+    }
+  }
+#endif
+
+  /**
+   * @brief 死区环节
+   * @details |x| 不大于 width 时输出0，否则向0平移 width，输出保持连续
+   */
+  struct Deadzone {
+    float width = 0.0f; /* 死区宽度 */
+
+    float Apply(float x, float dt) {
+      UNUSED(dt);
+      if (std::fabs(x) <= this->width) {
+        return 0.0f;
+      }
+      return x > 0.0f ? x - this->width : x + this->width;
+    }
+  };
+
+  /**
+   * @brief 一阶低通环节
+   */
+  struct FirstOrderLPF {
+    float tau = 0.0f;    /* 时间常数(s)，为0时直通 */
+    float state = 0.0f;  /* 滤波状态 */
+    bool inited = false; /* 状态是否已初始化 */
+
+    float Apply(float x, float dt) {
+      if (this->tau <= 0.0f || !this->inited) {
+        this->state = x;
+        this->inited = true;
+        return x;
+      }
+      this->state += (x - this->state) * dt / (this->tau + dt);
+      return this->state;
+    }
+  };
+
+  /**
+   * @brief 变化率限制环节
+   */
+  struct SlewLimit {
+    float rate = 0.0f;   /* 每秒最大变化量，为0时不限制 */
+    float last = 0.0f;   /* 上次输出 */
+    bool inited = false; /* 状态是否已初始化 */
+
+    float Apply(float x, float dt) {
+      if (this->rate > 0.0f && this->inited) {
+        const float step = this->rate * dt;
+        x = std::clamp(x, this->last - step, this->last + step);
+      }
+      this->last = x;
+      this->inited = true;
+      return x;
+    }
+  };
+
+  /**
+   * @brief 编译期组合的单轴滤波链
+   * @tparam Stages 按顺序执行的环节，每个环节提供 float Apply(float x, float dt)
+   */
+  template <typename... Stages>
+  class FilterPipeline {
+   public:
+    float Apply(float x, float dt) {
+      std::apply([&](Stages&... stage) { ((x = stage.Apply(x, dt)), ...); },
+                 this->stages_);
+      return x;
+    }
+
+    /**
+     * @brief 获取指定环节，用于配置参数
+     */
+    template <typename Stage>
+    Stage& Get() {
+      return std::get<Stage>(this->stages_);
+    }
+
+   private:
+    std::tuple<Stages...> stages_{};
+  };
+
+  /**
+   * @brief CMD 使用的单轴滤波链
+   */
+  using AxisFilter = FilterPipeline<Deadzone, FirstOrderLPF, SlewLimit>;
+
+  /**
+   * @brief 连续控制轴
+   * @details 用于逐轴配置滤波与活动阈值
+   */
+  enum class Axis : uint8_t {
+    CHASSIS_X,
+    CHASSIS_Y,
+    CHASSIS_Z,
+    GIMBAL_YAW,
+    GIMBAL_PIT,
+    GIMBAL_ROL,
+    AXIS_NUM
+  };
+
+  /**
+   * @brief 命令通道
+   */
+  enum class Channel : uint8_t { CHASSIS, GIMBAL, LAUNCHER, CHANNEL_NUM };
+
+  /**
+   * @brief 设置命令通道的AI生产者归属
+   * @param channel 命令通道
+   * @param producer AI生产者序号，默认所有通道归属生产者0
+   * @details 发布时每个通道只取其归属生产者的命令与在线状态，发射通道按其归属
+   *          生产者的 gimbal_online 判定在线；例如导航上位机控制底盘、自瞄上位机
+   *          控制云台与发射。需在开始写入输入前配置
+   */
+  void SetAIOwner(Channel channel, size_t producer) {
+    if (channel >= Channel::CHANNEL_NUM || producer >= AI_PRODUCER_NUM) {
+      return;
+    }
+    this->ai_owner_[static_cast<size_t>(channel)] =
+        static_cast<uint8_t>(producer);
+  }
+
+  /**
+   * @brief 控制事件ID
+   */
+  enum {
+    CMD_EVENT_START_CTRL = 0x13212508, /* 开始控制事件ID */
+    CMD_EVENT_LOST_CTRL = 0x13212509   /* 丢失控制事件ID */
+  };
+
+  /**
+   * @brief 获取当前控制模式
+   * @return 当前控制模式
+   */
+  Mode GetCtrlMode() {
+    if constexpr (!Policy::AUTO_CTRL) {
+      return Mode::CMD_OP_CTRL;
+    }
+    return this->mode_.load(std::memory_order_relaxed);
+  }
+
+  bool GetAIGimbalStatus() {
+    return (this->AIOwner(Channel::GIMBAL).online.load(
+                std::memory_order_relaxed) &
+            AI_ONLINE_GIMBAL) != 0;
+  }
+
+  /**
+   * @brief 获取CMD模块的事件处理器
+   * @return 事件处理器引用
+   * @details 用于其他模块绑定事件或激活事件
+   */
+  LibXR::Event& GetEvent() { return cmd_event_; }
+
+  /**
+   * @brief 获取在线状态
+   * @return 是否在线
+   */
+  bool Online() { return this->online_; }
+
+  /**
+   * @brief 直接写入遥控器控制数据
+   * @details 兼容接口，默认按DR16输入源写入
+   */
+  void FeedRC(const Data& rc_data) {
+    this->FeedRC(RCInputSource::RC_INPUT_DR16, rc_data);
+  }
+
+  /**
+   * @brief 按遥控输入源写入控制数据
+   * @details 每个输入源只允许一个写入者，写入输入槽为O(1)且无需关中断，
+   *          发布侧通过顺序锁读取一致快照。定频与锁相模式下只写入并标记
+   *          待发布，可在中断中调用；同步模式下在调用者上下文中完成整个
+   *          发布流程（含 Topic::Publish 与事件回调），不得在中断中调用
+   */
+  void FeedRC(RCInputSource source, const Data& rc_data) {
+    this->WriteRCInput(source, [&](Data& slot) { slot = rc_data; });
+  }
+
+  /**
+   * @brief 直接写入 AI 控制数据
+   * @details 单写入者，写入方式同 FeedRC
+   */
+  void FeedAI(const Data& ai_data) { this->FeedAI(0, ai_data); }
+
+  /**
+   * @brief 按AI生产者写入控制数据
+   * @param producer AI生产者序号
+   * @param ai_data AI控制数据
+   * @details 各生产者独占输入槽，可同时全速写入，互不覆盖
+   */
+  void FeedAI(size_t producer, const Data& ai_data) {
+    this->WriteAIInput(producer, [&](Data& slot) { slot = ai_data; });
+  }
+
+  /**
+   * @brief 写入带上位机时间戳的 AI 控制数据
+   * @param ai_data AI控制数据
+   * @param host_capture_us 该帧对应的上位机采集时刻，上位机时钟(us)
+   * @details CMD 内部估计上位机与本机的时钟偏差，将采集时刻换算到本机时钟，
+   *          云台外推按采集时刻计算，从而补偿传输时延；需配合 SetAIPrediction
+   */
+  void FeedAI(const Data& ai_data, uint32_t host_capture_us) {
+    this->FeedAI(0, ai_data, host_capture_us);
+  }
+
+  /**
+   * @brief 按AI生产者写入带上位机时间戳的控制数据
+   * @details 每个生产者独立估计其上位机的时钟偏差
+   */
+  void FeedAI(size_t producer, const Data& ai_data, uint32_t host_capture_us) {
+    if (producer >= AI_PRODUCER_NUM) {
+      return;
+    }
+    const uint32_t arrival_us = this->NowUs();
+    this->WriteAIInput(
+        producer, [&](Data& slot) { slot = ai_data; }, arrival_us,
+        this->EstimateAICapture(this->ai_input_[producer], host_capture_us,
+                                arrival_us),
+        host_capture_us);
+  }
+
+  /**
+   * @brief 直接写入AI紧凑数据包
+   * @param packet 接收缓冲区，格式见 AIPacketField
+   * @return 校验通过返回 OK，长度不符返回 SIZE_ERR，帧头或掩码非法返回 ARG_ERR，
+   *         CRC错误返回 CHECK_ERR
+   * @details 在接收缓冲区上原地校验，只把出现的字段写入AI输入槽
+   */
+  LibXR::ErrorCode FeedAIPacket(const LibXR::ConstRawData& packet) {
+    return this->FeedAIPacket(0, packet);
+  }
+
+  /**
+   * @brief 按AI生产者写入紧凑数据包
+   * @return 生产者序号越界返回 ARG_ERR，其余同 FeedAIPacket
+   */
+  LibXR::ErrorCode FeedAIPacket(size_t producer,
+                                const LibXR::ConstRawData& packet) {
+    if (producer >= AI_PRODUCER_NUM) {
+      return LibXR::ErrorCode::ARG_ERR;
+    }
+    const auto* buf = static_cast<const uint8_t*>(packet.addr_);
+    if (packet.size_ < AIPacketSize(0)) {
+      return LibXR::ErrorCode::SIZE_ERR;
+    }
+    const uint8_t fields = buf[1];
+    if (buf[0] != AI_PACKET_HEADER || (fields & ~AI_FIELD_ALL) != 0) {
+      return LibXR::ErrorCode::ARG_ERR;
+    }
+    if (packet.size_ != AIPacketSize(fields)) {
+      return LibXR::ErrorCode::SIZE_ERR;
+    }
+    if (!LibXR::CRC16::Verify(buf, packet.size_)) {
+      return LibXR::ErrorCode::CHECK_ERR;
+    }
+
+    const uint8_t status = buf[2];
+    const uint8_t* field = buf + 3;
+    const uint32_t arrival_us = this->NowUs();
+    uint32_t capture_us = arrival_us;
+    uint32_t host_capture_us = 0;
+    if (fields & AI_FIELD_TIMESTAMP) {
+      std::memcpy(&host_capture_us,
+                  buf + packet.size_ - sizeof(uint16_t) - sizeof(uint32_t),
+                  sizeof(uint32_t));
+      capture_us = this->EstimateAICapture(this->ai_input_[producer],
+                                           host_capture_us, arrival_us);
+    }
+
+    this->WriteAIInput(
+        producer,
+        [&](Data& slot) {
+          slot.chassis_online = (status & 0x01) != 0;
+          slot.gimbal_online = (status & 0x02) != 0;
+          slot.ctrl_source = ControlSource::CTRL_SOURCE_AI;
+          if (fields & AI_FIELD_GIMBAL_ANGLE) {
+            std::memcpy(&slot.gimbal.yaw, field, 3 * sizeof(float));
+            field += 3 * sizeof(float);
+          }
+          if (fields & AI_FIELD_GIMBAL_DERIV) {
+            std::memcpy(&slot.gimbal.yaw_dot, field, 6 * sizeof(float));
+            field += 6 * sizeof(float);
+          }
+          if (fields & AI_FIELD_CHASSIS) {
+            std::memcpy(&slot.chassis.x, field, 3 * sizeof(float));
+            field += 3 * sizeof(float);
+            slot.chassis.self_define = static_cast<ChasStat>(*field++);
+          }
+          if (fields & AI_FIELD_LAUNCHER) {
+            slot.launcher.isfire = (*field++ != 0);
+          }
+        },
+        arrival_us, capture_us, host_capture_us);
+
+    return LibXR::ErrorCode::OK;
+  }
+
+  /**
+   * @brief 紧急停止
+   * @param in_isr 是否在中断中调用
+   * @details 可在任意上下文中调用，不经过仲裁立即发布零底盘命令、保持当前姿态的
+   *          云台命令与禁止开火，并锁存；锁存期间正常发布流程全部被阻断，
+   *          直到调用 ReleaseEmergencyStop
+   */
+  void EmergencyStop(bool in_isr = false) {
+    const uint32_t begin_us = this->NowUs();
+    this->estop_.store(true, std::memory_order_release);
+    this->PublishStop(in_isr);
+#if CMD_CAN_BRIDGE
+    this->SendBridgeEStop(true);
+#endif
+    this->estop_latency_us_.store(this->NowUs() - begin_us,
+                                  std::memory_order_relaxed);
+#if CMD_RECORDER
+    this->AppendRecord(RecordType::ESTOP, 0, 0, Data{}, begin_us);
+#endif
+  }
+
+  /**
+   * @brief 解除紧急停止
+   * @details 解除后所有通道按当前输入重新完整发布一次
+   */
+  void ReleaseEmergencyStop() {
+    if (!this->estop_.exchange(false, std::memory_order_acq_rel)) {
+      return;
+    }
+#if CMD_RECORDER
+    this->AppendRecord(RecordType::ESTOP_RELEASE, 0, 0, Data{}, this->NowUs());
+#endif
+#if CMD_CAN_BRIDGE
+    this->SendBridgeEStop(false);
+#endif
+    this->gimbal_cache_.valid = false;
+    this->chassis_cache_.valid = false;
+    this->launcher_cache_.valid = false;
+    this->publish_pending_.store(true, std::memory_order_release);
+    this->DrainPublish();
+  }
+
+  /**
+   * @brief 是否处于紧急停止锁存状态
+   */
+  bool IsEmergencyStopped() const {
+    return this->estop_.load(std::memory_order_acquire);
+  }
+
+  /**
+   * @brief 获取最近一次紧急停止从调用到发布完成的耗时(us)
+   */
+  uint32_t GetEmergencyStopLatency() const {
+    return this->estop_latency_us_.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief 定频发布节拍
+   * @details 定频模式下由定时器周期调用，仅在有新输入时汇总并发布一次；
+   *          同步模式下无需调用
+   */
+  void PublishTick() {
+    this->CheckStale();
+    /* 启用预测时AI云台命令每个节拍都需要外推发布 */
+    const AIInput& gimbal_ai = this->AIOwner(Channel::GIMBAL);
+    if (this->ai_predict_horizon_us_ != 0 &&
+        this->GetCtrlMode() == Mode::CMD_AUTO_CTRL &&
+        (gimbal_ai.online.load(std::memory_order_relaxed) &
+         AI_ONLINE_GIMBAL) != 0 &&
+        !gimbal_ai.stale.load(std::memory_order_relaxed)) {
+      this->publish_pending_.store(true, std::memory_order_release);
+    }
+    /* 无扰切换过渡期间每个节拍都需要发布 */
+    if (this->gimbal_bumpless_.blending || this->chassis_bumpless_.blending) {
+      this->publish_pending_.store(true, std::memory_order_release);
+    }
+    this->DrainPublish();
+  }
+
+  /**
+   * @brief CMD构造函数
+   * @param hw 硬件容器引用
+   * @param app 应用管理器引用
+   * @param mode 控制模式，CMDOpOnlyPolicy 下固定为 CMD_OP_CTRL
+   * @param chassis_cmd_topic_name 底盘命令主题名称
+   * @param gimbal_cmd_topic_name 云台命令主题名称
+   * @param launcher_cmd_topic_name 发射命令主题名称
+   * @param publish_period_ms 定频发布周期(ms)，为0时每次输入立即发布
+   * @param link_stats_topic_name 输入链路统计主题名称，多个实例需各不相同；
+   *                              CMD_LINK_STATS 为0时忽略
+   * @param latency_topic_name 时延统计主题名称，多个实例需各不相同；
+   *                           CMD_LATENCY_STATS 为0时忽略
+   */
+  BasicCMD(LibXR::HardwareContainer& hw, LibXR::ApplicationManager& app,
+           Mode mode, const char* chassis_cmd_topic_name,
+           const char* gimbal_cmd_topic_name,
+           const char* launcher_cmd_topic_name, uint32_t publish_period_ms = 0,
+           const char* link_stats_topic_name = "cmd_link_stats",
+           const char* latency_topic_name = "cmd_latency")
+      : mode_(Policy::AUTO_CTRL ? mode : Mode::CMD_OP_CTRL),
+        publish_period_ms_(publish_period_ms),
+        chassis_data_tp_(chassis_cmd_topic_name, sizeof(ChassisCMD), nullptr,
+                         true),
+        gimbal_data_tp_(gimbal_cmd_topic_name, sizeof(GimbalCMD), nullptr,
+                        true),
+        fire_data_tp_(launcher_cmd_topic_name, sizeof(LauncherCMD), nullptr,
+                      true) {
+    UNUSED(hw);
+    UNUSED(app);
+#if CMD_LINK_STATS
+    this->link_stats_tp_ = LibXR::Topic(link_stats_topic_name,
+                                        sizeof(LinkReport), nullptr, true);
+#else
+    UNUSED(link_stats_topic_name);
+#endif
+#if CMD_LATENCY_STATS
+    this->latency_tp_ = LibXR::Topic(latency_topic_name, sizeof(LatencyReport),
+                                     nullptr, true);
+#else
+    UNUSED(latency_topic_name);
+#endif
+    /* 创建事件回调函数 */
+    auto callback = LibXR::Callback<uint32_t>::Create(
+        [](bool in_isr, BasicCMD* cmd, uint32_t event_id) {
+          UNUSED(in_isr);
+          cmd->EventHandler(event_id);
+        },
+        this);
+    /* 注册控制模式事件处理回调 */
+    this->cmd_event_.Register(static_cast<uint32_t>(Mode::CMD_OP_CTRL),
+                              callback);
+    if constexpr (Policy::AUTO_CTRL) {
+      this->cmd_event_.Register(static_cast<uint32_t>(Mode::CMD_AUTO_CTRL),
+                                callback);
+    }
+
+#if CMD_LATENCY_STATS && CMD_LATENCY_USE_DWT
+    /* 使能 DWT 周期计数器，Cortex-M7 需先写 LAR 解锁 DWT 寄存器 */
+    constexpr uintptr_t DEMCR_ADDR = 0xE000EDFC;
+    constexpr uintptr_t DWT_CTRL_ADDR = 0xE0001000;
+    constexpr uintptr_t DWT_LAR_ADDR = 0xE0001FB0;
+    constexpr uint32_t DWT_LAR_KEY = 0xC5ACCE55;
+    *reinterpret_cast<volatile uint32_t*>(DEMCR_ADDR) |= (1u << 24);
+    *reinterpret_cast<volatile uint32_t*>(DWT_LAR_ADDR) = DWT_LAR_KEY;
+    *reinterpret_cast<volatile uint32_t*>(DWT_CTRL_ADDR) |= 1u;
+#endif
+
+    /* 定频模式下创建发布定时任务 */
+    if (this->publish_period_ms_ > 0) {
+      auto publish_task = LibXR::Timer::CreateTask(
+          PublishTimerTask, this, this->publish_period_ms_);
+      LibXR::Timer::Add(publish_task);
+      LibXR::Timer::Start(publish_task);
+    }
+  }
+
+  /**
+   * @brief 设置控制模式
+   * @param mode 要设置的控制模式
+   * @details 模式变化时立即重新汇总并发布一次，不等待下一次输入
+   */
+  void SetCtrlMode(Mode mode) {
+    if constexpr (!Policy::AUTO_CTRL) {
+      mode = Mode::CMD_OP_CTRL;
+    }
+    if (this->mode_.exchange(mode, std::memory_order_relaxed) == mode) {
+      return;
+    }
+#if CMD_RECORDER
+    this->AppendRecord(RecordType::MODE, static_cast<uint8_t>(mode), 0, Data{},
+                       this->NowUs());
+#endif
+    this->publish_pending_.store(true, std::memory_order_release);
+    this->DrainPublish();
+  }
+
+  /**
+   * @brief 设置遥控输入的活动阈值
+   * @param axis 控制轴
+   * @param threshold 该轴绝对值超过阈值即视为有操作，默认0.05
+   * @details 在线且由静止变为有操作的遥控输入源会立即接管控制；
+   *          需在开始写入输入前完成配置
+   */
+  void SetActivityThreshold(Axis axis, float threshold) {
+    this->activity_threshold_[static_cast<size_t>(axis)] = threshold;
+  }
+
+  /**
+   * @brief 获取指定轴的滤波链
+   * @param axis 滤波轴
+   * @return 滤波链引用，通过 Get<Stage>() 配置各环节参数
+   * @details 滤波作用于仲裁选择之后、发布之前；首次获取后即启用滤波，
+   *          需在开始写入输入前完成配置
+   */
+#if CMD_INPUT_FILTER
+  AxisFilter& GetFilter(Axis axis) {
+    this->filter_enabled_ = true;
+    return this->filters_[static_cast<size_t>(axis)];
+  }
+#endif
+
+  /**
+   * @brief 设置无扰切换过渡时间
+   * @param window_ms 云台/底盘命令在遥控与AI之间切换时的线性过渡时间(ms)，
+   *                  为0时直接切换
+   * @details 过渡作用于云台 yaw/pit/rol 与底盘 x/y/z，速度与加速度项直接取新源
+   */
+  void SetBumplessWindow(uint32_t window_ms) {
+    this->bumpless_window_us_ = window_ms * 1000;
+  }
+
+  /**
+   * @brief 事件处理器
+   * @param event_id 事件ID
+   * @details 处理来自事件系统的控制模式切换请求
+   */
+  void EventHandler(uint32_t event_id) {
+    this->SetCtrlMode(static_cast<Mode>(event_id));
+  }
+
+  /**
+   * @brief 注册控制器
+   * @tparam SourceDataType 源数据类型
+   * @param source 源主题
+   * @details 将外部控制源的数据接入CMD系统，并进行预处理和分发
+   */
+  template <typename SourceDataType>
+  void RegisterController(LibXR::Topic& source) {
+    using Traits = CMDControllerTraits<SourceDataType>;
+    static_assert(Policy::AUTO_CTRL ||
+                      Traits::CTRL_SOURCE == ControlSource::CTRL_SOURCE_RC,
+                  "CMDOpOnlyPolicy accepts RC controllers only");
+
+    /* 在主题回调中直接从主题缓冲区转换到输入槽，不经过中间Data */
+    auto callback = LibXR::Topic::Callback::Create(
+        [](bool in_isr, BasicCMD* cmd, LibXR::RawData& data) {
+          UNUSED(in_isr);
+          if (data.size_ < sizeof(SourceDataType)) {
+            return;
+          }
+          const auto& src = *static_cast<const SourceDataType*>(data.addr_);
+          if constexpr (Traits::CTRL_SOURCE == ControlSource::CTRL_SOURCE_RC) {
+            cmd->WriteRCInput(Traits::RC_INPUT,
+                              [&](Data& slot) { Traits::Convert(src, slot); });
+          } else if constexpr (requires { Traits::AI_PRODUCER; }) {
+            cmd->WriteAIInput(Traits::AI_PRODUCER,
+                              [&](Data& slot) { Traits::Convert(src, slot); });
+          } else {
+            cmd->WriteAIInput(0,
+                              [&](Data& slot) { Traits::Convert(src, slot); });
+          }
+        },
+        this);
+    source.RegisterCallback(callback);
+  }
+
+  /**
+   * @brief 设置变化检测发布策略
+   * @param epsilon 浮点字段判定为变化的阈值，为0时按值精确比较
+   * @param keep_alive_ms 未变化通道的保活重发周期(ms)，为0时每次都发布
+   * @details 仅发布内容变化的通道，未变化通道按保活周期重发，
+   *          保证下游的在线超时检测仍然有效
+   */
+  void SetPublishFilter(float epsilon, uint32_t keep_alive_ms) {
+    this->publish_epsilon_ = epsilon;
+    this->publish_keep_alive_us_ = keep_alive_ms * 1000;
+    /* 关闭期间缓存不再更新，重新启用时不能与旧内容比较 */
+    this->chassis_cache_.valid = false;
+    this->launcher_cache_.valid = false;
+  }
+
+  /**
+   * @brief 启用完整命令帧主题
+   * @param topic_name 命令帧主题名称
+   * @param bundle_only 为true时不再发布底盘/云台/发射三路主题
+   * @details 每次发布流程只 Publish 一次 CMDFrame，订阅者拿到的三路命令
+   *          始终来自同一次发布；需在开始写入输入前调用
+   */
+  void EnableBundleTopic(const char* topic_name, bool bundle_only = false) {
+    this->bundle_tp_ =
+        LibXR::Topic(topic_name, sizeof(CMDFrame), nullptr, true);
+    this->bundle_only_ = bundle_only;
+    this->bundle_enabled_ = true;
+  }
+
+  /**
+   * @brief 设置AI云台命令外推
+   * @param horizon_ms 最大外推时间(ms)，为0时关闭外推
+   * @param max_offset 单轴角度外推量上限，为0时不限制
+   * @details 按AI命令中的角速度与角加速度，将最近一帧云台命令外推到发布时刻。
+   *          配合定频模式使用时，云台命令按发布周期输出，不再受视觉链路帧率限制
+   */
+  void SetAIPrediction(uint32_t horizon_ms, float max_offset) {
+    this->ai_predict_horizon_us_ = horizon_ms * 1000;
+    this->ai_predict_max_offset_ = max_offset;
+  }
+
+  /**
+   * @brief 设置AI链路的最小传输时延
+   * @param min_delay_us 已知的最小单向时延(us)，例如串口帧传输时间
+   * @details 时钟偏差估计只能得到偏差与最小时延之和，该值用于从中扣除最小时延
+   */
+  void SetAILinkDelay(uint32_t min_delay_us) {
+    this->SetAILinkDelay(0, min_delay_us);
+  }
+
+  /**
+   * @brief 设置指定AI生产者链路的最小传输时延
+   */
+  void SetAILinkDelay(size_t producer, uint32_t min_delay_us) {
+    if (producer < AI_PRODUCER_NUM) {
+      this->ai_input_[producer].link_delay_us = min_delay_us;
+    }
+  }
+
+  /**
+   * @brief 设置控制事件的防抖与派发方式
+   * @param dwell_ms 在线状态需持续该时间才判定为边沿，为0时立即判定
+   * @param deferred 为true时事件先入队，由 OnMonitor / DispatchEvents 派发
+   * @details 延迟派发可避免事件回调运行在输入写入者（可能是中断）的上下文中
+   */
+  void SetEventPolicy(uint32_t dwell_ms, bool deferred) {
+    this->event_dwell_us_ = dwell_ms * 1000;
+    this->event_deferred_ = deferred;
+  }
+
+  /**
+   * @brief 派发已入队的控制事件
+   * @details 延迟派发模式下由 OnMonitor 调用，也可由单独的工作线程调用；
+   *          同一时刻只允许一个派发者
+   */
+  void DispatchEvents() {
+    uint32_t tail = this->event_tail_.load(std::memory_order_relaxed);
+    while (tail != this->event_head_.load(std::memory_order_acquire)) {
+      const uint32_t event_id = this->event_queue_[tail % EVENT_QUEUE_SIZE];
+      this->event_tail_.store(tail + 1, std::memory_order_release);
+      this->cmd_event_.Active(event_id);
+      tail++;
+    }
+  }
+
+  /**
+   * @brief 设置输入超时时间
+   * @param timeout_ms 输入源超过该时间未写入即视为离线，为0时不检测
+   * @details 不依赖上游驱动的在线标志，静默的链路在超时后立即降级，
+   *          失去控制时立即触发 CMD_EVENT_LOST_CTRL
+   */
+  void SetStaleTimeout(uint32_t timeout_ms) {
+    this->stale_timeout_us_ = timeout_ms * 1000;
+  }
+
+#if CMD_PHASE_LOCK
+  /**
+   * @brief 将发布锁相到下游控制周期
+   * @param trigger 下游控制周期的触发主题，例如驱动云台/底盘控制环的IMU主题
+   * @param lead_us 触发主题发布到下游读取命令之间的时间(us)，即发布需领先的量
+   * @details 输入只写入数据并标记待发布，每次触发时在触发主题的发布者上下文中
+   *          汇总并发布一次，定频定时器不再发布。下游在同一触发下读取命令时，
+   *          命令总在读取前完成发布，下游读到的命令时龄不再在0到一个周期之间
+   *          变化；相位误差见 GetPhaseStats。需在开始写入输入前调用
+   */
+  void SetPhaseLock(LibXR::Topic& trigger, uint32_t lead_us) {
+    this->phase_lead_us_ = lead_us;
+    this->phase_locked_ = true;
+    auto callback = LibXR::Topic::Callback::Create(
+        [](bool in_isr, BasicCMD* cmd, LibXR::RawData& data) {
+          UNUSED(in_isr);
+          UNUSED(data);
+          cmd->OnPhaseTrigger();
+        },
+        this);
+    trigger.RegisterCallback(callback);
+  }
+#endif
+
+#if CMD_QUANTIZED_TOPIC
+  /**
+   * @brief 启用定点命令帧主题
+   * @param topic_name 定点命令帧主题名称
+   * @param scale 各字段定点分辨率，订阅者解码时需使用相同分辨率
+   * @details 每次发布流程额外 Publish 一次 QCMDFrame（32字节，CMDFrame 的
+   *          一半左右），与三路主题及完整命令帧同时发布；需在开始写入输入前调用
+   */
+  void EnableQuantizedTopic(const char* topic_name,
+                            const QuantScale& scale = DEFAULT_QUANT_SCALE) {
+    this->quant_tp_ =
+        LibXR::Topic(topic_name, sizeof(QCMDFrame), nullptr, true);
+    this->quant_scale_ = scale;
+    this->quant_enabled_ = true;
+  }
+#endif
+
+#if CMD_HOST_EULER_TOPIC
+  /**
+   * @brief 启用上位机姿态反馈
+   * @tparam SourceDataType IMU欧拉角主题的数据类型，需特化 CMDEulerTraits
+   * @param imu_euler IMU欧拉角主题
+   * @param topic_name 姿态反馈主题名称
+   * @param period_ms 锁存最小间隔(ms)，为0时锁存每个IMU样本
+   * @details 在IMU主题回调中锁存姿态并发布 HostEuler；未缓存主题的订阅者
+   *          拿到的是锁存缓冲区本身，AI链路也可通过 ReadHostEuler 直接序列化
+   */
+  template <typename SourceDataType>
+  void EnableHostEulerTopic(LibXR::Topic& imu_euler, const char* topic_name,
+                            uint32_t period_ms) {
+    this->host_euler_data_tp_ =
+        LibXR::Topic(topic_name, sizeof(HostEuler), nullptr, true);
+    this->host_euler_period_us_ = period_ms * 1000;
+
+    auto callback = LibXR::Topic::Callback::Create(
+        [](bool in_isr, BasicCMD* cmd, LibXR::RawData& data) {
+          if (data.size_ < sizeof(SourceDataType)) {
+            return;
+          }
+          cmd->LatchHostEuler(
+              *static_cast<const SourceDataType*>(data.addr_), in_isr);
+        },
+        this);
+    imu_euler.RegisterCallback(callback);
+  }
+
+  /**
+   * @brief 读取最近锁存的姿态反馈
+   * @param reader 以 `const HostEuler&` 调用，可直接写入发送缓冲区；
+   *               读取被锁存打断时会再次调用，只应写入可覆盖的目标
+   * @return 读取成功返回true，尚未锁存或持续被打断返回false
+   */
+  template <typename Reader>
+  bool ReadHostEuler(Reader&& reader) const {
+    if (this->host_euler_seq_.load(std::memory_order_acquire) == 0) {
+      return false;
+    }
+    return SeqLockVisit(this->host_euler_seq_, this->host_euler_, reader);
+  }
+#endif
+
+#if CMD_CAN_BRIDGE
+  /**
+   * @brief 命令桥角色
+   */
+  enum class BridgeRole : uint8_t {
+    NONE,      /* 未启用 */
+    AUTHORITY, /* 主控端，仲裁并发送命令 */
+    MIRROR,    /* 镜像端，接收并在本地重新发布命令 */
+  };
+
+  /**
+   * @brief 命令桥帧类型，帧ID为 base_id 加帧类型
+   * @details 每帧8字节，字节0为发布序号，多字节字段为小端 int16 定点数：
+   *          - STATE：字节1为状态位，字节2~7为底盘 x/y/z；每次发布都发送，
+   *            镜像端收到后提交本轮命令
+   *          - GIMBAL_ANGLE / GIMBAL_RATE / GIMBAL_ACCEL：字节2~7为云台三轴
+   *            角度 / 角速度 / 角加速度；内容不变时只按保活周期重发
+   *          - ESTOP：字节1为紧急停止锁存状态
+   */
+  enum class BridgeFrame : uint8_t {
+    STATE,
+    GIMBAL_ANGLE,
+    GIMBAL_RATE,
+    GIMBAL_ACCEL,
+    ESTOP,
+    FRAME_NUM
+  };
+
+  /**
+   * @brief 命令桥状态位
+   */
+  enum BridgeFlag : uint8_t {
+    BRIDGE_FLAG_RC_CHASSIS_ONLINE = 1u << 0, /* 遥控底盘在线 */
+    BRIDGE_FLAG_RC_GIMBAL_ONLINE = 1u << 1,  /* 遥控云台在线 */
+    BRIDGE_FLAG_FIRE = 1u << 2,              /* 开火 */
+    BRIDGE_FLAG_AUTO_CTRL = 1u << 3,         /* 自动控制模式 */
+    BRIDGE_FLAG_AI_CHASSIS = 1u << 4,        /* 底盘命令来自AI */
+    BRIDGE_FLAG_AI_GIMBAL = 1u << 5,         /* 云台命令来自AI */
+    BRIDGE_FLAG_CHAS_STAT_SHIFT = 6,         /* 字节高2位为底盘小模式 */
+  };
+
+  /**
+   * @brief 命令桥统计
+   */
+  struct BridgeStats {
+    uint32_t sent;       /* 发送帧数 */
+    uint32_t suppressed; /* 内容未变而省去的云台帧数 */
+    uint32_t failed;     /* 发送队列满而丢弃的帧数 */
+    uint32_t received;   /* 接收帧数 */
+    uint32_t lost;       /* 按发布序号推算的丢失轮数 */
+  };
+
+  /**
+   * @brief 启用跨板CAN命令桥
+   * @param can CAN设备
+   * @param role 本实例的角色
+   * @param base_id 起始帧ID，占用 base_id ~ base_id + FRAME_NUM - 1 的标准帧
+   * @param keep_alive_ms 云台帧内容不变时的重发周期(ms)，为0时每次都发送
+   * @param scale 定点分辨率，两端需使用相同分辨率
+   * @details 主控端每次发布后发送各帧，状态帧携带在线状态、模式、开火与底盘
+   *          命令，云台帧只在量化后内容变化或保活到期时发送；镜像端收到状态帧
+   *          后按本地发布策略重新发布，并复现主控端的在线状态、控制模式与
+   *          紧急停止。镜像端的输入、外推与滤波不应启用；设置输入超时后，
+   *          与主控端失联超时即按离线命令发布。镜像端在 CAN 接收回调中写入，
+   *          写入规则同 FeedRC，CAN 回调运行在中断中时须使用定频或锁相模式。
+   *          需在开始写入输入前调用
+   */
+  void EnableCANBridge(LibXR::CAN& can, BridgeRole role, uint32_t base_id,
+                       uint32_t keep_alive_ms = 100,
+                       const QuantScale& scale = DEFAULT_QUANT_SCALE) {
+    this->bridge_can_ = &can;
+    this->bridge_scale_ = scale;
+    this->bridge_base_id_ = base_id;
+    this->bridge_keep_alive_us_ = keep_alive_ms * 1000;
+    this->bridge_role_ = role;
+    /* 镜像端需复现主控端的自动模式输出 */
+    ASSERT(Policy::AUTO_CTRL || role != BridgeRole::MIRROR);
+    if (role != BridgeRole::MIRROR) {
+      return;
+    }
+
+    auto callback = LibXR::CAN::Callback::Create(
+        [](bool in_isr, BasicCMD* cmd, const LibXR::CAN::ClassicPack& pack) {
+          cmd->OnBridgeFrame(pack, in_isr);
+        },
+        this);
+    can.Register(callback, LibXR::CAN::Type::STANDARD,
+                 LibXR::CAN::FilterMode::ID_RANGE, base_id,
+                 base_id + static_cast<uint32_t>(BridgeFrame::FRAME_NUM) - 1);
+  }
+
+  /**
+   * @brief 获取命令桥统计
+   */
+  const BridgeStats& GetBridgeStats() const { return this->bridge_stats_; }
+#endif
+
+  /**
+   * @brief 注入时钟源
+   * @param now_us 返回当前时刻(us)的函数，为nullptr时恢复使用 LibXR::Timebase
+   * @param arg 传给 now_us 的参数
+   * @details 用于回放与仿真，需在开始写入输入前设置
+   */
+  void SetClock(uint32_t (*now_us)(void*), void* arg) {
+    this->clock_arg_ = arg;
+    this->clock_ = now_us;
+  }
+
+  /**
+   * @brief 由调用者驱动定频发布节拍
+   * @param enable 为 true 时定时任务不再调用 PublishTick
+   * @details 用于回放与仿真，定频模式下的发布时刻完全由调用者调用
+   *          PublishTick 决定，与真实定时器无关；需在开始写入输入前设置
+   */
+  void SetExternalTick(bool enable) {
+    this->external_tick_.store(enable, std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief 监控函数重写
+   */
+  void OnMonitor() override {
+    this->CheckStale();
+    this->CheckEventDwell();
+    this->DispatchEvents();
+#if CMD_LINK_STATS
+    this->UpdateLinkStats();
+#endif
+#if CMD_LATENCY_STATS
+    this->latency_tp_.Publish(this->latency_);
+#endif
+  }
+
+ private:
+  bool online_ = false;        /* 在线状态 */
+  std::atomic<Mode> mode_;     /* 当前控制模式 */
+  uint32_t publish_period_ms_; /* 定频发布周期，0为同步发布 */
+  std::atomic<bool> publish_pending_{false}; /* 是否有待发布的新输入 */
+  bool phase_locked_ = false; /* 是否锁相到下游控制周期 */
+  std::atomic<bool> external_tick_{false}; /* 定频节拍是否由调用者驱动 */
+#if CMD_PHASE_LOCK
+  uint32_t phase_lead_us_ = 0;      /* 发布需领先下游读取的时间 */
+  uint32_t phase_last_tick_us_ = 0; /* 上次触发时刻 */
+  uint32_t phase_period_acc_ = 0;   /* 触发周期滑动平均累加器 */
+  uint32_t phase_error_acc_ = 0;    /* 相位误差滑动平均累加器 */
+  PhaseStats phase_stats_{};        /* 锁相发布统计 */
+#endif
+  std::atomic_flag publish_busy_ = ATOMIC_FLAG_INIT; /* 发布流程占用标志 */
+  LibXR::Event cmd_event_;                           /* 事件处理器 */
+#if !CMD_LOW_FOOTPRINT
+  std::array<Data, Policy::AUTO_CTRL
+                       ? static_cast<size_t>(ControlSource::CTRL_SOURCE_NUM)
+                       : 1>
+      data_{}; /* 各控制源的数据快照，CMDOpOnlyPolicy 下只有遥控 */
+#endif
+  std::array<Data, static_cast<size_t>(RCInputSource::RC_INPUT_NUM)>
+      rc_input_data_{}; /* 各遥控输入源的数据 */
+  std::array<std::atomic<uint32_t>,
+             static_cast<size_t>(RCInputSource::RC_INPUT_NUM)>
+      rc_input_seq_{};                    /* 各遥控输入源的顺序锁序号 */
+
+  /* AIInput::online 的在线位 */
+  static constexpr uint8_t AI_ONLINE_CHASSIS = 1u << 0;
+  static constexpr uint8_t AI_ONLINE_GIMBAL = 1u << 1;
+
+  /**
+   * @brief 单个AI生产者的输入槽与链路状态
+   * @details 顺序锁之外只读取原子成员，在线状态由写入者缓存在 online 中
+   */
+  struct AIInput {
+    Data data{};                         /* 输入数据 */
+    std::atomic<uint32_t> seq{0};        /* 顺序锁序号 */
+    std::atomic<uint32_t> arrival_us{0}; /* 最近写入时刻 */
+    std::atomic<uint32_t> capture_us{0}; /* 对应的本机采集时刻 */
+    std::atomic<bool> stale{false};      /* 是否已超时 */
+    std::atomic<uint8_t> online{0};      /* 写入时缓存的在线位 */
+    bool clock_synced = false;           /* 时钟偏差估计是否已初始化 */
+    int32_t clock_offset_us = 0;         /* 本机减上位机时钟的偏差估计 */
+    uint32_t link_delay_us = 0;          /* 链路已知最小传输时延 */
+#if CMD_HOST_EULER_TOPIC
+    std::atomic<uint32_t> host_us{0}; /* 最近一条命令的上位机时间戳 */
+#endif
+#if CMD_LINK_STATS
+    std::atomic<uint32_t> max_gap_us{0}; /* 最大帧间隔 */
+#endif
+#if CMD_LATENCY_STATS
+    std::atomic<uint32_t> feed_tick{0}; /* 待统计的写入时刻 */
+#endif
+  };
+
+  std::array<AIInput, AI_PRODUCER_NUM> ai_input_{}; /* 各AI生产者 */
+  std::array<uint8_t, static_cast<size_t>(Channel::CHANNEL_NUM)>
+      ai_owner_{}; /* 各通道归属的AI生产者 */
+  LibXR::Topic chassis_data_tp_;          /* 底盘命令主题 */
+  LibXR::Topic gimbal_data_tp_;           /* 云台命令主题 */
+  LibXR::Topic fire_data_tp_;             /* 开火命令主题 */
+#if CMD_HOST_EULER_TOPIC
+  LibXR::Topic host_euler_data_tp_; /* 上位机欧拉角主题 */
+  HostEuler host_euler_{};          /* 最近锁存的姿态，仅IMU回调写入 */
+  std::atomic<uint32_t> host_euler_seq_{0}; /* 锁存姿态的顺序锁序号 */
+  uint32_t host_euler_period_us_ = 0;       /* 锁存最小间隔 */
+#endif
+  std::atomic<RCInputSource> active_rc_input_{
+      RCInputSource::RC_INPUT_DR16};       /* 当前活动遥控输入源 */
+  std::atomic<uint32_t> rc_update_seq_{0}; /* 遥控输入数据更新序号 */
+  std::atomic<uint32_t> rc_online_mask_{0}; /* 遥控输入源在线掩码 */
+  std::atomic<uint32_t> rc_active_mask_{0}; /* 遥控输入源有操作掩码，按输入源序号 */
+  std::array<float, static_cast<size_t>(Axis::AXIS_NUM)> activity_threshold_ =
+      MakeActivityThreshold(); /* 各轴活动阈值 */
+  PublishCounters counters_{};              /* 发布计数 */
+  LibXR::Topic bundle_tp_;                  /* 完整命令帧主题 */
+  CMDFrame bundle_{};                       /* 完整命令帧 */
+  bool bundle_enabled_ = false;             /* 是否发布完整命令帧 */
+  bool bundle_only_ = false;                /* 是否只发布完整命令帧 */
+  std::array<std::atomic<uint32_t>,
+             static_cast<size_t>(RCInputSource::RC_INPUT_NUM)>
+      rc_arrival_us_{};                    /* 各遥控输入源最近写入时刻 */
+  uint32_t stale_timeout_us_ = 0;          /* 输入超时时间，0为不检测 */
+  std::atomic<bool> estop_{false};         /* 紧急停止锁存 */
+  std::atomic<uint32_t> estop_latency_us_{0}; /* 最近一次紧急停止耗时 */
+  uint32_t event_dwell_us_ = 0;            /* 在线边沿防抖时间 */
+  uint32_t edge_since_us_ = 0;             /* 待确认边沿的起始时刻 */
+  bool edge_pending_ = false;              /* 是否有待确认的在线边沿 */
+  bool event_deferred_ = false;            /* 是否延迟派发事件 */
+  static constexpr uint32_t EVENT_QUEUE_SIZE = 8; /* 事件队列长度 */
+  std::array<uint32_t, EVENT_QUEUE_SIZE> event_queue_{}; /* 事件队列 */
+  std::atomic<uint32_t> event_head_{0}; /* 事件队列写位置，仅发布流程写入 */
+  std::atomic<uint32_t> event_tail_{0}; /* 事件队列读位置，仅派发者写入 */
+  uint32_t ai_predict_horizon_us_ = 0;     /* AI云台外推时间上限，0为关闭 */
+
+  /**
+   * @brief 单个通道的无扰切换状态
+   */
+  struct BumplessState {
+    std::array<float, 3> last{}; /* 上次输出 */
+    std::array<float, 3> from{}; /* 过渡起点 */
+    uint32_t since_us = 0;       /* 过渡开始时刻 */
+    bool from_ai = false;        /* 当前输出是否来自AI */
+    bool blending = false;       /* 是否处于过渡中 */
+  };
+
+  uint32_t bumpless_window_us_ = 0;   /* 无扰切换过渡时间，0为直接切换 */
+  BumplessState gimbal_bumpless_{};   /* 云台通道无扰切换状态 */
+  BumplessState chassis_bumpless_{};  /* 底盘通道无扰切换状态 */
+#if CMD_INPUT_FILTER
+  std::array<AxisFilter, static_cast<size_t>(Axis::AXIS_NUM)>
+      filters_{};               /* 各轴滤波链 */
+  bool filter_enabled_ = false; /* 是否启用滤波 */
+  uint32_t filter_last_us_ = 0; /* 上次滤波时刻 */
+#endif
+  float ai_predict_max_offset_ = 0.0f;     /* AI云台单轴外推量上限 */
+  uint32_t (*clock_)(void*) = nullptr;     /* 注入的时钟源 */
+  void* clock_arg_ = nullptr;              /* 注入时钟源的参数 */
+
+#if CMD_RECORDER
+  std::array<Record, CMD_RECORDER_SIZE> record_ring_{}; /* 飞行记录环形缓冲区 */
+  std::array<std::atomic<uint32_t>, CMD_RECORDER_SIZE>
+      record_commit_{};                    /* 各槽位的提交号 */
+  std::atomic<uint32_t> record_head_{0};   /* 记录写位置 */
+  uint32_t record_tail_ = 0;               /* 记录导出位置，仅导出者写入 */
+  uint32_t record_dropped_ = 0;            /* 被覆盖的记录条数 */
+  uint32_t replay_now_us_ = 0;             /* 回放时钟 */
+  uint32_t replay_published_ = 0;          /* 回放中尚未对应到记录的发布次数 */
+#endif
+
+#if CMD_LINK_STATS
+  LinkReport link_report_{}; /* 输入链路统计 */
+  std::array<std::atomic<uint32_t>,
+             static_cast<size_t>(RCInputSource::RC_INPUT_NUM)>
+      rc_max_gap_us_{};                    /* 各遥控输入源最大帧间隔 */
+  std::atomic<uint32_t> failover_count_{0}; /* 遥控输入源切换次数 */
+  uint32_t link_stats_period_us_ = 1000000; /* 统计周期 */
+  uint32_t link_stats_last_us_ = 0;         /* 上次统计时刻 */
+  std::array<uint32_t, static_cast<size_t>(RCInputSource::RC_INPUT_NUM) +
+                           AI_PRODUCER_NUM>
+      link_stats_offline_us_{}; /* 各链路不足1ms的离线时间余量，AI在后 */
+  LibXR::Topic link_stats_tp_; /* 输入链路统计主题 */
+#endif
+
+#if CMD_INVARIANT_CHECK
+  InvariantReport invariant_report_{}; /* 不变量检查报告 */
+#endif
+
+#if CMD_QUANTIZED_TOPIC
+  LibXR::Topic quant_tp_;                         /* 定点命令帧主题 */
+  QuantScale quant_scale_ = DEFAULT_QUANT_SCALE;  /* 定点命令帧分辨率 */
+  uint16_t quant_seq_ = 0;                        /* 定点命令帧序号 */
+  bool quant_enabled_ = false;                    /* 是否发布定点命令帧 */
+#endif
+
+#if CMD_CAN_BRIDGE
+  /**
+   * @brief 镜像端的一轮命令
+   * @details data 的在线状态为主控端遥控输入的在线状态
+   */
+  struct BridgeSlot {
+    Data data{};             /* 命令与遥控在线状态 */
+    bool ai_chassis = false; /* 底盘命令是否来自AI */
+    bool ai_gimbal = false;  /* 云台命令是否来自AI */
+  };
+
+  BridgeRole bridge_role_ = BridgeRole::NONE; /* 命令桥角色 */
+  LibXR::CAN* bridge_can_ = nullptr;          /* 命令桥CAN设备 */
+  QuantScale bridge_scale_ = DEFAULT_QUANT_SCALE; /* 命令桥定点分辨率 */
+  uint32_t bridge_base_id_ = 0;               /* 命令桥起始帧ID */
+  uint32_t bridge_keep_alive_us_ = 0;         /* 云台帧保活周期 */
+  uint8_t bridge_seq_ = 0;                    /* 主控端发布序号 */
+  uint8_t bridge_refresh_ = 0xff; /* 需无条件发送的云台帧，按帧类型位 */
+  std::array<std::array<int16_t, 3>, 3> bridge_last_{}; /* 各云台帧上次内容 */
+  std::array<uint32_t, 3> bridge_last_us_{}; /* 各云台帧上次发送时刻 */
+  BridgeStats bridge_stats_{};               /* 命令桥统计 */
+  QGimbalCMD bridge_rx_gimbal_{}; /* 镜像端接收中的云台命令，仅CAN回调写入 */
+  BridgeSlot bridge_slot_{};  /* 镜像端已提交的命令 */
+  std::atomic<uint32_t> bridge_slot_seq_{0};   /* 已提交命令的顺序锁序号 */
+  std::atomic<uint32_t> bridge_arrival_us_{0}; /* 最近一次提交时刻 */
+  std::atomic<bool> bridge_stale_{false};      /* 与主控端是否已失联 */
+  uint8_t bridge_rx_seq_ = 0;                  /* 最近收到的发布序号 */
+  bool bridge_rx_synced_ = false;              /* 是否收到过状态帧 */
+#endif
+
+#if CMD_LATENCY_STATS
+  LatencyReport latency_{}; /* 时延统计 */
+  std::array<std::atomic<uint32_t>,
+             static_cast<size_t>(RCInputSource::RC_INPUT_NUM)>
+      rc_feed_tick_{};                   /* 各遥控输入源待统计的写入时刻 */
+  LibXR::Topic latency_tp_; /* 时延统计主题 */
+#endif
+
+  /**
+   * @brief 单个命令通道的发布缓存
+   */
+  template <typename CMDType>
+  struct PublishCache {
+    CMDType last{};       /* 上次发布的命令 */
+    uint32_t last_us = 0; /* 上次发布时间 */
+    bool valid = false;   /* 是否发布过 */
+  };
+
+  float publish_epsilon_ = 0.0f;       /* 变化检测阈值 */
+  uint32_t publish_keep_alive_us_ = 0; /* 保活重发周期，0为每次发布 */
+  PublishCache<GimbalCMD> gimbal_cache_{};     /* 云台通道发布缓存 */
+  PublishCache<ChassisCMD> chassis_cache_{};   /* 底盘通道发布缓存 */
+  PublishCache<LauncherCMD> launcher_cache_{}; /* 发射通道发布缓存 */
+
+  /*--------------------------工具函数-------------------------------------------------*/
+  static void PublishTimerTask(BasicCMD* cmd) {
+    if (!cmd->phase_locked_ &&
+        !cmd->external_tick_.load(std::memory_order_relaxed)) {
+      cmd->PublishTick();
+    }
+  }
+
+#if CMD_PHASE_LOCK
+  /* 滑动平均累加器保存8倍均值，避免小误差在整数移位中被舍去 */
+  static uint32_t UpdateAverage(uint32_t& acc, uint32_t sample) {
+    constexpr uint32_t PHASE_AVG_SHIFT = 3;
+
+    acc += sample - (acc >> PHASE_AVG_SHIFT);
+    return acc >> PHASE_AVG_SHIFT;
+  }
+
+  /* 相位误差只统计本次触发确有发布的情况 */
+  void OnPhaseTrigger() {
+    PhaseStats& stats = this->phase_stats_;
+    const uint32_t tick_us = this->NowUs();
+    const uint32_t interval = tick_us - this->phase_last_tick_us_;
+    if (stats.ticks == 1) {
+      this->phase_period_acc_ = interval << 3;
+      stats.period_us = interval;
+    } else if (stats.ticks > 1) {
+      const auto deviation =
+          static_cast<int32_t>(interval - stats.period_us);
+      const auto jitter = static_cast<uint32_t>(std::abs(deviation));
+      stats.max_jitter_us = std::max(stats.max_jitter_us, jitter);
+      stats.period_us = UpdateAverage(this->phase_period_acc_, interval);
+    }
+    this->phase_last_tick_us_ = tick_us;
+    stats.ticks++;
+
+    const uint32_t published = this->counters_.published;
+    this->PublishTick();
+    if (this->counters_.published == published) {
+      return;
+    }
+
+    const uint32_t error = this->NowUs() - tick_us;
+    stats.mean_error_us = UpdateAverage(this->phase_error_acc_, error);
+    stats.last_error_us = error;
+    stats.max_error_us = std::max(stats.max_error_us, error);
+    if (error > this->phase_lead_us_) {
+      stats.late++;
+    }
+  }
+#endif
+
+  static constexpr std::array<float, static_cast<size_t>(Axis::AXIS_NUM)>
+  MakeActivityThreshold() {
+    constexpr float RC_ACTIVITY_EPS = 0.05f;
+
+    std::array<float, static_cast<size_t>(Axis::AXIS_NUM)> threshold{};
+    threshold.fill(RC_ACTIVITY_EPS);
+    return threshold;
+  }
+
+  uint32_t NowUs() const {
+    if (this->clock_ != nullptr) {
+      return this->clock_(this->clock_arg_);
+    }
+    return static_cast<uint32_t>(
+        static_cast<uint64_t>(LibXR::Timebase::GetMicroseconds()));
+  }
+
+#if CMD_RECORDER
+  static uint32_t ReplayClock(void* arg) {
+    return static_cast<BasicCMD*>(arg)->replay_now_us_;
+  }
+
+  /* 多写入者各自占用一个槽位，提交号为记录序号加1，写入期间为0 */
+  void AppendRecord(RecordType type, uint8_t arg, uint32_t aux,
+                    const Data& data, uint32_t now_us) {
+    const uint32_t index =
+        this->record_head_.fetch_add(1, std::memory_order_relaxed);
+    const uint32_t slot = index % CMD_RECORDER_SIZE;
+    this->record_commit_[slot].store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    Record& record = this->record_ring_[slot];
+    record.time_us = now_us;
+    record.aux = aux;
+    record.type = type;
+    record.arg = arg;
+    record.index = static_cast<uint16_t>(index);
+    record.data = data;
+    this->record_commit_[slot].store(index + 1, std::memory_order_release);
+  }
+#endif
+
+  /* 超时的输入源从在线掩码中移除，有源被降级时立即发布一次 */
+  void CheckStale() {
+    if (this->stale_timeout_us_ == 0) {
+      return;
+    }
+
+    const uint32_t now_us = this->NowUs();
+    bool demoted = false;
+
+    for (size_t i = 0; i < this->rc_arrival_us_.size(); i++) {
+      const uint32_t bit = RCInputArbiter::Bit(i);
+      const uint32_t arrival =
+          this->rc_arrival_us_[i].load(std::memory_order_relaxed);
+      if (!(this->rc_online_mask_.load(std::memory_order_relaxed) & bit) ||
+          now_us - arrival <= this->stale_timeout_us_) {
+        continue;
+      }
+      this->rc_online_mask_.fetch_and(~bit, std::memory_order_acq_rel);
+      /* 清除期间有新写入则恢复 */
+      if (this->rc_arrival_us_[i].load(std::memory_order_acquire) != arrival) {
+        this->rc_online_mask_.fetch_or(bit, std::memory_order_acq_rel);
+        continue;
+      }
+      demoted = true;
+    }
+
+#if CMD_CAN_BRIDGE
+    if (this->bridge_role_ == BridgeRole::MIRROR && this->bridge_rx_synced_ &&
+        !this->bridge_stale_.load(std::memory_order_relaxed) &&
+        now_us - this->bridge_arrival_us_.load(std::memory_order_relaxed) >
+            this->stale_timeout_us_) {
+      this->bridge_stale_.store(true, std::memory_order_relaxed);
+      demoted = true;
+    }
+#endif
+
+    for (AIInput& ai : this->ai_input_) {
+      const bool ai_online = ai.online.load(std::memory_order_relaxed) != 0;
+      if (ai_online && !ai.stale.load(std::memory_order_relaxed) &&
+          now_us - ai.arrival_us.load(std::memory_order_relaxed) >
+              this->stale_timeout_us_) {
+        ai.stale.store(true, std::memory_order_relaxed);
+        demoted = true;
+      }
+    }
+
+    if (demoted) {
+      this->publish_pending_.store(true, std::memory_order_release);
+      this->DrainPublish();
+    }
+  }
+
+  void RequestPublish() {
+    this->publish_pending_.store(true, std::memory_order_release);
+    if (this->publish_period_ms_ == 0 && !this->phase_locked_) {
+      this->DrainPublish();
+    }
+  }
+
+#if CMD_LATENCY_STATS
+  /* 计时单位见 LatencyStats，按32位回绕计算差值 */
+  static uint32_t LatencyNow() {
+#if CMD_LATENCY_USE_DWT
+    constexpr uintptr_t DWT_CYCCNT_ADDR = 0xE0001004;
+    return *reinterpret_cast<volatile uint32_t*>(DWT_CYCCNT_ADDR);
+#else
+    return static_cast<uint32_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch())
+            .count());
+#endif
+  }
+
+  /* 统计待处理的写入时刻，写入时刻的最低位恒为1，0表示无待统计样本 */
+  static void RecordFeedLatency(std::atomic<uint32_t>& feed_tick,
+                                LatencyStats& stats, uint32_t end) {
+    const uint32_t begin = feed_tick.exchange(0, std::memory_order_relaxed);
+    if (begin != 0) {
+      stats.Record(end - begin);
+    }
+  }
+
+  void RecordLatency(uint32_t process_begin, uint32_t publish_begin) {
+    const uint32_t end = LatencyNow();
+    this->latency_.process.Record(end - process_begin);
+    this->latency_.publish.Record(end - publish_begin);
+    for (size_t i = 0; i < this->rc_feed_tick_.size(); i++) {
+      RecordFeedLatency(this->rc_feed_tick_[i],
+                        this->latency_.rc_feed_to_publish[i], end);
+    }
+    for (size_t i = 0; i < this->ai_input_.size(); i++) {
+      RecordFeedLatency(this->ai_input_[i].feed_tick,
+                        this->latency_.ai_feed_to_publish[i], end);
+    }
+  }
+#endif
+
+  /* 二阶外推单轴角度与角速度，角度外推量按上限截断 */
+  static void PredictAxis(float& angle, float& dot, float ddot, float dt,
+                          float max_offset) {
+    float offset = dot * dt + 0.5f * ddot * dt * dt;
+    if (max_offset > 0.0f) {
+      offset = std::clamp(offset, -max_offset, max_offset);
+    }
+    angle += offset;
+    dot += ddot * dt;
+  }
+
+  void PredictAIGimbal(GimbalCMD& gimbal, uint32_t now_us) {
+    uint32_t age_us = now_us - this->AIOwner(Channel::GIMBAL)
+                                   .capture_us.load(std::memory_order_relaxed);
+    if (age_us > this->ai_predict_horizon_us_) {
+      age_us = this->ai_predict_horizon_us_;
+    }
+    const float dt = static_cast<float>(age_us) * 1e-6f;
+    PredictAxis(gimbal.yaw, gimbal.yaw_dot, gimbal.yaw_ddot, dt,
+                this->ai_predict_max_offset_);
+    PredictAxis(gimbal.pit, gimbal.pit_dot, gimbal.pit_ddot, dt,
+                this->ai_predict_max_offset_);
+    PredictAxis(gimbal.rol, gimbal.rol_dot, gimbal.rol_ddot, dt,
+                this->ai_predict_max_offset_);
+  }
+
+  /* 在线状态保持防抖时间后才判定边沿并触发事件 */
+  void UpdateOnline(bool online, uint32_t now_us) {
+    if (online == this->online_) {
+      this->edge_pending_ = false;
+      return;
+    }
+    if (!this->edge_pending_) {
+      this->edge_pending_ = true;
+      this->edge_since_us_ = now_us;
+    }
+    if (now_us - this->edge_since_us_ < this->event_dwell_us_) {
+      return;
+    }
+
+    this->edge_pending_ = false;
+    this->online_ = online;
+    this->EmitEvent(online ? CMD_EVENT_START_CTRL : CMD_EVENT_LOST_CTRL);
+  }
+
+  /* 输入停止时没有新的发布流程，由监控周期推动待确认边沿 */
+  void CheckEventDwell() {
+    if (this->edge_pending_ &&
+        this->NowUs() - this->edge_since_us_ >= this->event_dwell_us_) {
+      this->publish_pending_.store(true, std::memory_order_release);
+      this->DrainPublish();
+    }
+  }
+
+  /* 仅在发布流程中调用，队列满时丢弃新事件 */
+  void EmitEvent(uint32_t event_id) {
+    if (!this->event_deferred_) {
+      this->cmd_event_.Active(event_id);
+      return;
+    }
+    const uint32_t head = this->event_head_.load(std::memory_order_relaxed);
+    if (head - this->event_tail_.load(std::memory_order_acquire) >=
+        EVENT_QUEUE_SIZE) {
+      return;
+    }
+    this->event_queue_[head % EVENT_QUEUE_SIZE] = event_id;
+    this->event_head_.store(head + 1, std::memory_order_release);
+  }
+
+#if CMD_INPUT_FILTER
+  void ApplyFilters(ChassisCMD& chassis, GimbalCMD& gimbal, uint32_t now_us) {
+    const float dt =
+        static_cast<float>(now_us - this->filter_last_us_) * 1e-6f;
+    this->filter_last_us_ = now_us;
+
+    auto filter = [&](Axis axis, float& value) {
+      value = this->filters_[static_cast<size_t>(axis)].Apply(value, dt);
+    };
+    filter(Axis::CHASSIS_X, chassis.x);
+    filter(Axis::CHASSIS_Y, chassis.y);
+    filter(Axis::CHASSIS_Z, chassis.z);
+    filter(Axis::GIMBAL_YAW, gimbal.yaw);
+    filter(Axis::GIMBAL_PIT, gimbal.pit);
+    filter(Axis::GIMBAL_ROL, gimbal.rol);
+  }
+#endif
+
+  /* 输出源切换时从上次输出线性过渡到新源，始终记录本次输出作为下次起点 */
+  void ApplyBumpless(BumplessState& state, bool from_ai, float& a, float& b,
+                     float& c, uint32_t now_us) {
+    if (from_ai != state.from_ai) {
+      state.from_ai = from_ai;
+      state.from = state.last;
+      state.since_us = now_us;
+      state.blending = this->bumpless_window_us_ != 0;
+    }
+
+    if (state.blending) {
+      const uint32_t elapsed_us = now_us - state.since_us;
+      if (elapsed_us >= this->bumpless_window_us_) {
+        state.blending = false;
+      } else {
+        const float alpha = static_cast<float>(elapsed_us) /
+                            static_cast<float>(this->bumpless_window_us_);
+        a = state.from[0] + (a - state.from[0]) * alpha;
+        b = state.from[1] + (b - state.from[1]) * alpha;
+        c = state.from[2] + (c - state.from[2]) * alpha;
+      }
+    }
+
+    state.last = {a, b, c};
+  }
+
+#if CMD_LINK_STATS
+  /* 仅由该链路的写入者在写入后调用；首帧没有上一帧，不计间隔 */
+  static void RecordGap(std::atomic<uint32_t>& max_gap_us, uint32_t seq,
+                        uint32_t gap_us) {
+    if (seq > 2 && gap_us > max_gap_us.load(std::memory_order_relaxed)) {
+      max_gap_us.store(gap_us, std::memory_order_relaxed);
+    }
+  }
+
+  /* 以顺序锁序号统计帧数，每个统计周期更新帧率与离线时间并发布 */
+  void UpdateLinkStats() {
+    const uint32_t now_us = this->NowUs();
+    const uint32_t elapsed_us = now_us - this->link_stats_last_us_;
+    if (elapsed_us < this->link_stats_period_us_) {
+      return;
+    }
+    this->link_stats_last_us_ = now_us;
+    const float elapsed_s = static_cast<float>(elapsed_us) * 1e-6f;
+
+    auto update = [&](LinkStats& stats, uint32_t seq, uint32_t max_gap_us,
+                      bool online, uint32_t& offline_rem_us) {
+      const uint32_t frames = seq / 2;
+      stats.rate_hz = static_cast<float>(frames - stats.frames) / elapsed_s;
+      stats.frames = frames;
+      stats.max_gap_us = max_gap_us;
+      if (!online) {
+        offline_rem_us += elapsed_us;
+        stats.offline_ms += offline_rem_us / 1000;
+        offline_rem_us %= 1000;
+      }
+    };
+
+    const uint32_t online_mask =
+        this->rc_online_mask_.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < this->link_report_.rc.size(); i++) {
+      update(this->link_report_.rc[i],
+             this->rc_input_seq_[i].load(std::memory_order_relaxed),
+             this->rc_max_gap_us_[i].load(std::memory_order_relaxed),
+             (online_mask & RCInputArbiter::Bit(i)) != 0,
+             this->link_stats_offline_us_[i]);
+    }
+    for (size_t i = 0; i < this->ai_input_.size(); i++) {
+      const AIInput& ai = this->ai_input_[i];
+      const bool ai_online = ai.online.load(std::memory_order_relaxed) != 0 &&
+                             !ai.stale.load(std::memory_order_relaxed);
+      update(this->link_report_.ai[i], ai.seq.load(std::memory_order_relaxed),
+             ai.max_gap_us.load(std::memory_order_relaxed), ai_online,
+             this->link_stats_offline_us_[this->link_report_.rc.size() + i]);
+    }
+    this->link_report_.failover_count =
+        this->failover_count_.load(std::memory_order_relaxed);
+
+    this->link_stats_tp_.Publish(this->link_report_);
+  }
+#endif
+
+#if !CMD_LOW_FOOTPRINT
+  /* AI快照存于data_，CMDOpOnlyPolicy 下AI恒为离线，使用调用者的局部变量 */
+  Data& AISnapshot(Data& local) {
+    if constexpr (Policy::AUTO_CTRL) {
+      UNUSED(local);
+      return this->data_[static_cast<size_t>(ControlSource::CTRL_SOURCE_AI)];
+    } else {
+      return local;
+    }
+  }
+#endif
+
+  /* 紧急停止命令只在局部构造，不触碰发布流程的状态，可抢占发布流程执行 */
+  void PublishStop(bool in_isr) {
+    ChassisCMD chassis{};
+    chassis.self_define = ChasStat::NONE;
+    /* 只发布完整命令帧时云台通道缓存不更新，从命令帧取最近姿态 */
+    const GimbalCMD& hold =
+        this->bundle_only_ ? this->bundle_.gimbal : this->gimbal_cache_.last;
+    GimbalCMD gimbal{};
+    gimbal.yaw = hold.yaw;
+    gimbal.pit = hold.pit;
+    gimbal.rol = hold.rol;
+    LauncherCMD launcher{};
+    launcher.isfire = false;
+
+    if (!this->bundle_only_) {
+      this->gimbal_data_tp_.PublishFromCallback(gimbal, in_isr);
+      this->chassis_data_tp_.PublishFromCallback(chassis, in_isr);
+      this->fire_data_tp_.PublishFromCallback(launcher, in_isr);
+    }
+    if (this->bundle_enabled_) {
+      CMDFrame frame{};
+      frame.gimbal = gimbal;
+      frame.chassis = chassis;
+      frame.launcher = launcher;
+      frame.ctrl_source = ControlSource::CTRL_SOURCE_RC;
+      frame.seq = this->bundle_.seq;
+#if CMD_FRAME_META
+      /* 停止命令不来自任何输入，按生成时刻标记 */
+      const uint32_t now_us = this->NowUs();
+      frame.meta.chassis_arrival_us = now_us;
+      frame.meta.gimbal_arrival_us = now_us;
+      frame.meta.chassis_source = ControlSource::CTRL_SOURCE_RC;
+      frame.meta.gimbal_source = ControlSource::CTRL_SOURCE_RC;
+      frame.meta.rc_input = RCInputSource::RC_INPUT_NUM;
+#endif
+      this->bundle_tp_.PublishFromCallback(frame, in_isr);
+    }
+#if CMD_QUANTIZED_TOPIC
+    if (this->quant_enabled_) {
+      QCMDFrame frame{EncodeGimbal(gimbal, this->quant_scale_),
+                      EncodeChassis(chassis, this->quant_scale_),
+                      launcher,
+                      false,
+                      false,
+                      ControlSource::CTRL_SOURCE_RC,
+                      this->quant_seq_};
+      this->quant_tp_.PublishFromCallback(frame, in_isr);
+    }
+#endif
+  }
+
+  /* 同一时刻只允许一个发布流程，被抢占的请求由当前发布者补发 */
+  void DrainPublish() {
+    do {
+      if (this->publish_busy_.test_and_set(std::memory_order_acquire)) {
+        return;
+      }
+      while (this->publish_pending_.exchange(false, std::memory_order_acq_rel)) {
+        this->ProcessAndPublish();
+      }
+      this->publish_busy_.clear(std::memory_order_release);
+    } while (this->publish_pending_.load(std::memory_order_acquire));
+  }
+
+  template <typename Writer>
+  void WriteRCInput(RCInputSource source, Writer&& writer) {
+    const auto source_index = static_cast<size_t>(source);
+    if (source_index >= static_cast<size_t>(RCInputSource::RC_INPUT_NUM)) {
+      return;
+    }
+
+    Data& slot = this->rc_input_data_[source_index];
+    SeqLockWrite(this->rc_input_seq_[source_index], slot, writer);
+    this->rc_update_seq_.fetch_add(1, std::memory_order_relaxed);
+    const uint32_t now_us = this->NowUs();
+#if CMD_LINK_STATS
+    RecordGap(this->rc_max_gap_us_[source_index],
+              this->rc_input_seq_[source_index].load(std::memory_order_relaxed),
+              now_us - this->rc_arrival_us_[source_index].load(
+                           std::memory_order_relaxed));
+#endif
+    this->rc_arrival_us_[source_index].store(now_us,
+                                             std::memory_order_relaxed);
+
+    /* 本源为该槽唯一写入者，写完后可直接读取并缓存在线与活动状态 */
+    const uint32_t online_bit = RCInputArbiter::Bit(source_index);
+    const uint32_t active_bit = 1u << source_index;
+    const bool online = this->IsRCInputOnline(slot);
+    const bool was_active =
+        (this->rc_active_mask_.load(std::memory_order_relaxed) & active_bit) !=
+        0;
+    const bool active = online && this->IsRCInputActive(slot, was_active);
+
+    if (online) {
+      this->rc_online_mask_.fetch_or(online_bit, std::memory_order_release);
+    } else {
+      this->rc_online_mask_.fetch_and(~online_bit, std::memory_order_release);
+    }
+    if (active) {
+      this->rc_active_mask_.fetch_or(active_bit, std::memory_order_relaxed);
+    } else {
+      this->rc_active_mask_.fetch_and(~active_bit, std::memory_order_relaxed);
+    }
+
+    /* 仅在由静止变为有操作时接管，持续有操作的源不会反复抢占 */
+    if (active && !was_active) {
+      this->active_rc_input_.store(source, std::memory_order_relaxed);
+    }
+
+#if CMD_LATENCY_STATS
+    this->rc_feed_tick_[source_index].store(LatencyNow() | 1u,
+                                            std::memory_order_relaxed);
+#endif
+#if CMD_RECORDER
+    this->AppendRecord(RecordType::FEED_RC, static_cast<uint8_t>(source_index),
+                       0, slot, now_us);
+#endif
+
+    this->RequestPublish();
+  }
+
+  template <typename Writer>
+  void WriteAIInput(size_t producer, Writer&& writer) {
+    const uint32_t now_us = this->NowUs();
+    this->WriteAIInput(producer, writer, now_us, now_us);
+  }
+
+  /* host_us 为命令携带的上位机时间戳，与输入数据在同一顺序锁写入内更新 */
+  template <typename Writer>
+  void WriteAIInput(size_t producer, Writer&& writer, uint32_t arrival_us,
+                    uint32_t capture_us, uint32_t host_us = 0) {
+    if (producer >= AI_PRODUCER_NUM) {
+      return;
+    }
+
+    AIInput& ai = this->ai_input_[producer];
+#if CMD_HOST_EULER_TOPIC
+    SeqLockWrite(ai.seq, ai.data, [&](Data& slot) {
+      writer(slot);
+      ai.host_us.store(host_us, std::memory_order_relaxed);
+    });
+#else
+    UNUSED(host_us);
+    SeqLockWrite(ai.seq, ai.data, writer);
+#endif
+    /* 本生产者为该槽唯一写入者，写完后可直接读取并缓存在线状态 */
+    ai.online.store(static_cast<uint8_t>(
+                        (ai.data.chassis_online ? AI_ONLINE_CHASSIS : 0) |
+                        (ai.data.gimbal_online ? AI_ONLINE_GIMBAL : 0)),
+                    std::memory_order_relaxed);
+    ai.capture_us.store(capture_us, std::memory_order_relaxed);
+#if CMD_LINK_STATS
+    RecordGap(ai.max_gap_us, ai.seq.load(std::memory_order_relaxed),
+              arrival_us - ai.arrival_us.load(std::memory_order_relaxed));
+#endif
+    ai.arrival_us.store(arrival_us, std::memory_order_relaxed);
+    ai.stale.store(false, std::memory_order_relaxed);
+#if CMD_LATENCY_STATS
+    ai.feed_tick.store(LatencyNow() | 1u, std::memory_order_relaxed);
+#endif
+#if CMD_RECORDER
+    this->AppendRecord(RecordType::FEED_AI, static_cast<uint8_t>(producer),
+                       capture_us, ai.data, arrival_us);
+#endif
+    this->RequestPublish();
+  }
+
+  /*
+   * 到达时刻减上位机时刻 = 时钟偏差 + 传输时延，取其最小值跟踪偏差与最小时延之和；
+   * 每帧上浮1us以跟随两端晶振的相对漂移。仅由该生产者的写入者调用
+   */
+  static uint32_t EstimateAICapture(AIInput& ai, uint32_t host_capture_us,
+                                    uint32_t arrival_us) {
+    constexpr int32_t AI_CLOCK_DRIFT_US = 1;
+
+    const auto sample = static_cast<int32_t>(arrival_us - host_capture_us);
+    if (!ai.clock_synced || sample < ai.clock_offset_us + AI_CLOCK_DRIFT_US) {
+      ai.clock_offset_us = sample;
+      ai.clock_synced = true;
+    } else {
+      ai.clock_offset_us += AI_CLOCK_DRIFT_US;
+    }
+
+    return host_capture_us + static_cast<uint32_t>(ai.clock_offset_us) -
+           ai.link_delay_us;
+  }
+
+  /* 没有AI生产者时各通道归属一个恒为离线的共享输入 */
+  const AIInput& AIOwner(Channel channel) const {
+    if constexpr (AI_PRODUCER_NUM == 0) {
+      static const AIInput OFFLINE{};
+      UNUSED(channel);
+      return OFFLINE;
+    } else {
+      return this->ai_input_[this->ai_owner_[static_cast<size_t>(channel)]];
+    }
+  }
+
+  /* 读取生产者快照，超时的生产者视为离线，发射请求随云台在线状态失效 */
+  static bool ReadAIInput(const AIInput& ai, Data& out) {
+    if (!SeqLockRead(ai.seq, ai.data, out)) {
+      return false;
+    }
+    if (ai.stale.load(std::memory_order_relaxed)) {
+      out.chassis_online = false;
+      out.gimbal_online = false;
+    }
+    out.launcher.isfire = out.launcher.isfire && out.gimbal_online;
+    return true;
+  }
+
+  /* 按通道归属合并各生产者快照，各通道同属一个生产者时直接读入；读取被打断返回false */
+  bool ReadAIData(Data& out) {
+    if constexpr (AI_PRODUCER_NUM == 0) {
+      out = Data{};
+      out.ctrl_source = ControlSource::CTRL_SOURCE_AI;
+      return true;
+    }
+    const size_t chassis_owner =
+        this->ai_owner_[static_cast<size_t>(Channel::CHASSIS)];
+    const size_t gimbal_owner =
+        this->ai_owner_[static_cast<size_t>(Channel::GIMBAL)];
+    const size_t launcher_owner =
+        this->ai_owner_[static_cast<size_t>(Channel::LAUNCHER)];
+    if (chassis_owner == gimbal_owner && gimbal_owner == launcher_owner) {
+      return ReadAIInput(this->ai_input_[chassis_owner], out);
+    }
+
+    Data snapshot;
+    for (size_t i = 0; i < this->ai_input_.size(); i++) {
+      if (chassis_owner != i && gimbal_owner != i && launcher_owner != i) {
+        continue;
+      }
+      if (!ReadAIInput(this->ai_input_[i], snapshot)) {
+        return false;
+      }
+      if (chassis_owner == i) {
+        out.chassis = snapshot.chassis;
+        out.chassis_online = snapshot.chassis_online;
+      }
+      if (gimbal_owner == i) {
+        out.gimbal = snapshot.gimbal;
+        out.gimbal_online = snapshot.gimbal_online;
+      }
+      if (launcher_owner == i) {
+        out.launcher = snapshot.launcher;
+      }
+    }
+    out.ctrl_source = ControlSource::CTRL_SOURCE_AI;
+    return true;
+  }
+
+  /* 顺序锁写入：序号为奇数期间表示数据正在更新 */
+  template <typename Slot, typename Writer>
+  static void SeqLockWrite(std::atomic<uint32_t>& seq, Slot& slot,
+                           Writer&& writer) {
+    const uint32_t begin = seq.load(std::memory_order_relaxed);
+    seq.store(begin + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    writer(slot);
+    seq.store(begin + 2, std::memory_order_release);
+  }
+
+  /* 顺序锁读取：有限次重试，失败说明写入者正在更新，其写完后会再次请求发布 */
+  template <typename Slot>
+  static bool SeqLockRead(const std::atomic<uint32_t>& seq, const Slot& slot,
+                          Slot& out) {
+    return SeqLockVisit(seq, slot, [&](const Slot& value) { out = value; });
+  }
+
+  /* 在槽上原地读取，reader 可能被重复调用，结果以最后一次为准 */
+  template <typename Slot, typename Reader>
+  static bool SeqLockVisit(const std::atomic<uint32_t>& seq, const Slot& slot,
+                           Reader&& reader) {
+    constexpr uint32_t SEQLOCK_MAX_RETRY = 4;
+
+    for (uint32_t retry = 0; retry < SEQLOCK_MAX_RETRY; retry++) {
+      const uint32_t begin = seq.load(std::memory_order_acquire);
+      if (begin & 1u) {
+        continue;
+      }
+      reader(slot);
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (seq.load(std::memory_order_relaxed) == begin) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  static bool IsRCInputOnline(const Data& rc_data) {
+    return rc_data.chassis_online;
+  }
+
+  /* 超过阈值判定为有操作，已有操作时需全部降到阈值的一半以下才释放 */
+  bool IsRCInputActive(const Data& rc_data, bool was_active) const {
+    constexpr float RC_ACTIVITY_RELEASE = 0.5f;
+
+    if ((rc_data.chassis.self_define != ChasStat::NONE) ||
+        rc_data.launcher.isfire) {
+      return true;
+    }
+
+    const float scale = was_active ? RC_ACTIVITY_RELEASE : 1.0f;
+    auto exceed = [&](Axis axis, float value) {
+      return std::fabs(value) >
+             this->activity_threshold_[static_cast<size_t>(axis)] * scale;
+    };
+    return exceed(Axis::CHASSIS_X, rc_data.chassis.x) ||
+           exceed(Axis::CHASSIS_Y, rc_data.chassis.y) ||
+           exceed(Axis::CHASSIS_Z, rc_data.chassis.z) ||
+           exceed(Axis::GIMBAL_YAW, rc_data.gimbal.yaw) ||
+           exceed(Axis::GIMBAL_PIT, rc_data.gimbal.pit) ||
+           exceed(Axis::GIMBAL_ROL, rc_data.gimbal.rol);
+  }
+
+  static bool IsSameCMD(const GimbalCMD& a, const GimbalCMD& b, float eps) {
+    return std::fabs(a.yaw - b.yaw) <= eps && std::fabs(a.pit - b.pit) <= eps &&
+           std::fabs(a.rol - b.rol) <= eps &&
+           std::fabs(a.yaw_dot - b.yaw_dot) <= eps &&
+           std::fabs(a.yaw_ddot - b.yaw_ddot) <= eps &&
+           std::fabs(a.pit_dot - b.pit_dot) <= eps &&
+           std::fabs(a.pit_ddot - b.pit_ddot) <= eps &&
+           std::fabs(a.rol_dot - b.rol_dot) <= eps &&
+           std::fabs(a.rol_ddot - b.rol_ddot) <= eps;
+  }
+
+  static bool IsSameCMD(const ChassisCMD& a, const ChassisCMD& b, float eps) {
+    return std::fabs(a.x - b.x) <= eps && std::fabs(a.y - b.y) <= eps &&
+           std::fabs(a.z - b.z) <= eps && a.self_define == b.self_define;
+  }
+
+  static bool IsSameCMD(const LauncherCMD& a, const LauncherCMD& b, float) {
+    return a.isfire == b.isfire;
+  }
+
+  /*
+   * 通道内容变化或保活到期时发布，否则跳过。命令主题不缓存数据，Publish 直接把
+   * cmd 所在的快照交给订阅者，不再经过中间缓冲区
+   */
+  template <typename CMDType>
+  void PublishChannel(LibXR::Topic& topic, CMDType& cmd,
+                      PublishCache<CMDType>& cache, uint32_t now_us) {
+    if (this->publish_keep_alive_us_ != 0 && cache.valid &&
+        now_us - cache.last_us < this->publish_keep_alive_us_ &&
+        IsSameCMD(cmd, cache.last, this->publish_epsilon_)) {
+      this->counters_.skipped++;
+      return;
+    }
+
+    topic.Publish(cmd);
+    this->counters_.published++;
+    /* 缓存只用于变化检测与紧急停止时保持云台姿态，不需要时省去复制 */
+    if (this->publish_keep_alive_us_ == 0 &&
+        !std::is_same_v<CMDType, GimbalCMD>) {
+      return;
+    }
+    cache.last = cmd;
+    cache.last_us = now_us;
+    cache.valid = true;
+  }
+
+  static void MakeOfflineRCData(Data& rc_data) {
+    rc_data = Data{};
+    rc_data.chassis_online = false;
+    rc_data.gimbal_online = false;
+    rc_data.ctrl_source = ControlSource::CTRL_SOURCE_RC;
+  }
+
+  /*
+   * 按在线掩码选择遥控输入源，仅将选中槽的快照读入out，selected为选中的输入源，
+   * 无在线输入源时为 RC_INPUT_NUM；读取被打断返回false
+   */
+  bool SelectRCData(Data& out, size_t& selected) {
+    const auto active_index = static_cast<size_t>(
+        this->active_rc_input_.load(std::memory_order_relaxed));
+    uint32_t online_mask =
+        this->rc_online_mask_.load(std::memory_order_acquire);
+
+    /* 掩码与快照之间可能相差一次写入，以快照为准剔除后重选 */
+    while (true) {
+      selected = RCInputArbiter::Select(online_mask, active_index);
+      if (selected >= RCInputArbiter::INPUT_NUM) {
+        selected = RCInputArbiter::INPUT_NUM;
+        MakeOfflineRCData(out);
+        return true;
+      }
+      if (!SeqLockRead(this->rc_input_seq_[selected],
+                       this->rc_input_data_[selected], out)) {
+        return false;
+      }
+      if (this->IsRCInputOnline(out)) {
+        if (selected != active_index) {
+          this->active_rc_input_.store(static_cast<RCInputSource>(selected),
+                                       std::memory_order_relaxed);
+#if CMD_LINK_STATS
+          this->failover_count_.fetch_add(1, std::memory_order_relaxed);
+#endif
+        }
+        return true;
+      }
+      online_mask &= ~RCInputArbiter::Bit(selected);
+    }
+  }
+
+#if CMD_CAN_BRIDGE
+  void SendBridgePack(BridgeFrame frame, const uint8_t (&data)[8]) {
+    LibXR::CAN::ClassicPack pack{};
+    pack.id = this->bridge_base_id_ + static_cast<uint32_t>(frame);
+    pack.type = LibXR::CAN::Type::STANDARD;
+    std::memcpy(pack.data, data, sizeof(data));
+    if (this->bridge_can_->AddMessage(pack) == LibXR::ErrorCode::OK) {
+      this->bridge_stats_.sent++;
+    } else {
+      this->bridge_stats_.failed++;
+    }
+  }
+
+  /* 云台帧先于状态帧发送，镜像端收到状态帧时本轮内容已全部到达 */
+  void SendBridgeFrames(const GimbalCMD& gimbal, const ChassisCMD& chassis,
+                        const LauncherCMD& launcher, const Data& rc_data,
+                        bool auto_ctrl, bool ai_chassis, bool ai_gimbal,
+                        uint32_t now_us) {
+    const uint8_t seq = ++this->bridge_seq_;
+    const QGimbalCMD q = EncodeGimbal(gimbal, this->bridge_scale_);
+    const std::array<std::array<int16_t, 3>, 3> gimbal_values = {{
+        {q.yaw, q.pit, q.rol},
+        {q.yaw_dot, q.pit_dot, q.rol_dot},
+        {q.yaw_ddot, q.pit_ddot, q.rol_ddot},
+    }};
+
+    for (size_t i = 0; i < gimbal_values.size(); i++) {
+      const std::array<int16_t, 3>& quantized = gimbal_values[i];
+      const uint8_t refresh_bit = static_cast<uint8_t>(1u << i);
+      if (!(this->bridge_refresh_ & refresh_bit) &&
+          this->bridge_keep_alive_us_ != 0 &&
+          now_us - this->bridge_last_us_[i] < this->bridge_keep_alive_us_ &&
+          quantized == this->bridge_last_[i]) {
+        this->bridge_stats_.suppressed++;
+        continue;
+      }
+      uint8_t data[8] = {seq};
+      std::memcpy(data + 2, quantized.data(), sizeof(quantized));
+      this->SendBridgePack(
+          static_cast<BridgeFrame>(
+              static_cast<size_t>(BridgeFrame::GIMBAL_ANGLE) + i),
+          data);
+      this->bridge_last_[i] = quantized;
+      this->bridge_last_us_[i] = now_us;
+      this->bridge_refresh_ &= static_cast<uint8_t>(~refresh_bit);
+    }
+
+    uint8_t flags =
+        static_cast<uint8_t>((static_cast<uint8_t>(chassis.self_define) & 0x3u)
+                             << BRIDGE_FLAG_CHAS_STAT_SHIFT);
+    flags |= rc_data.chassis_online ? BRIDGE_FLAG_RC_CHASSIS_ONLINE : 0;
+    flags |= rc_data.gimbal_online ? BRIDGE_FLAG_RC_GIMBAL_ONLINE : 0;
+    flags |= launcher.isfire ? BRIDGE_FLAG_FIRE : 0;
+    flags |= auto_ctrl ? BRIDGE_FLAG_AUTO_CTRL : 0;
+    flags |= ai_chassis ? BRIDGE_FLAG_AI_CHASSIS : 0;
+    flags |= ai_gimbal ? BRIDGE_FLAG_AI_GIMBAL : 0;
+    const QChassisCMD chassis_values =
+        EncodeChassis(chassis, this->bridge_scale_);
+    uint8_t data[8] = {seq, flags};
+    std::memcpy(data + 2, &chassis_values, 3 * sizeof(int16_t));
+    this->SendBridgePack(BridgeFrame::STATE, data);
+  }
+
+  void SendBridgeEStop(bool latched) {
+    if (this->bridge_role_ != BridgeRole::AUTHORITY) {
+      return;
+    }
+    const uint8_t data[8] = {this->bridge_seq_,
+                             latched ? uint8_t{1} : uint8_t{0}};
+    this->SendBridgePack(BridgeFrame::ESTOP, data);
+  }
+
+  /* 仅由CAN接收回调调用，云台帧暂存，状态帧到达时提交本轮命令 */
+  void OnBridgeFrame(const LibXR::CAN::ClassicPack& pack, bool in_isr) {
+    std::array<int16_t, 3> values{};
+    std::memcpy(values.data(), pack.data + 2, sizeof(values));
+    QGimbalCMD& gimbal = this->bridge_rx_gimbal_;
+    this->bridge_stats_.received++;
+
+    switch (static_cast<BridgeFrame>(pack.id - this->bridge_base_id_)) {
+      case BridgeFrame::GIMBAL_ANGLE:
+        gimbal.yaw = values[0];
+        gimbal.pit = values[1];
+        gimbal.rol = values[2];
+        break;
+      case BridgeFrame::GIMBAL_RATE:
+        gimbal.yaw_dot = values[0];
+        gimbal.pit_dot = values[1];
+        gimbal.rol_dot = values[2];
+        break;
+      case BridgeFrame::GIMBAL_ACCEL:
+        gimbal.yaw_ddot = values[0];
+        gimbal.pit_ddot = values[1];
+        gimbal.rol_ddot = values[2];
+        break;
+      case BridgeFrame::ESTOP:
+        if (pack.data[1] != 0) {
+          this->EmergencyStop(in_isr);
+        } else {
+          this->ReleaseEmergencyStop();
+        }
+        break;
+      case BridgeFrame::STATE: {
+        const uint8_t seq = pack.data[0];
+        const uint8_t flags = pack.data[1];
+        if (this->bridge_rx_synced_) {
+          this->bridge_stats_.lost +=
+              static_cast<uint8_t>(seq - this->bridge_rx_seq_ - 1);
+        }
+        this->bridge_rx_seq_ = seq;
+        this->bridge_rx_synced_ = true;
+
+        QChassisCMD chassis{};
+        std::memcpy(&chassis, values.data(), sizeof(values));
+        chassis.self_define =
+            static_cast<ChasStat>(flags >> BRIDGE_FLAG_CHAS_STAT_SHIFT);
+        BridgeSlot stage;
+        stage.data.gimbal = DecodeGimbal(gimbal, this->bridge_scale_);
+        stage.data.chassis = DecodeChassis(chassis, this->bridge_scale_);
+        stage.data.launcher.isfire = (flags & BRIDGE_FLAG_FIRE) != 0;
+        stage.data.chassis_online =
+            (flags & BRIDGE_FLAG_RC_CHASSIS_ONLINE) != 0;
+        stage.data.gimbal_online = (flags & BRIDGE_FLAG_RC_GIMBAL_ONLINE) != 0;
+        stage.ai_chassis = (flags & BRIDGE_FLAG_AI_CHASSIS) != 0;
+        stage.ai_gimbal = (flags & BRIDGE_FLAG_AI_GIMBAL) != 0;
+        this->mode_.store((flags & BRIDGE_FLAG_AUTO_CTRL) ? Mode::CMD_AUTO_CTRL
+                                                          : Mode::CMD_OP_CTRL,
+                          std::memory_order_relaxed);
+
+        SeqLockWrite(this->bridge_slot_seq_, this->bridge_slot_,
+                     [&](BridgeSlot& slot) { slot = stage; });
+        this->bridge_arrival_us_.store(this->NowUs(),
+                                       std::memory_order_relaxed);
+        this->bridge_stale_.store(false, std::memory_order_relaxed);
+        this->RequestPublish();
+        break;
+      }
+      default:
+        this->bridge_stats_.received--;
+        break;
+    }
+  }
+
+  /* 将镜像命令还原为遥控与AI快照，使镜像端按同一流程得到与主控端相同的输出 */
+  bool ReadBridgeData(Data& rc_data, Data& ai_data) {
+    BridgeSlot slot;
+    if (!SeqLockRead(this->bridge_slot_seq_, this->bridge_slot_, slot)) {
+      return false;
+    }
+    if (this->bridge_stale_.load(std::memory_order_relaxed)) {
+      slot = BridgeSlot{};
+    }
+
+    rc_data = Data{};
+    rc_data.chassis_online = slot.data.chassis_online;
+    rc_data.gimbal_online = slot.data.gimbal_online;
+    rc_data.ctrl_source = ControlSource::CTRL_SOURCE_RC;
+    ai_data = Data{};
+    ai_data.chassis_online = slot.ai_chassis;
+    ai_data.gimbal_online = slot.ai_gimbal;
+    ai_data.ctrl_source = ControlSource::CTRL_SOURCE_AI;
+    (slot.ai_chassis ? ai_data : rc_data).chassis = slot.data.chassis;
+    (slot.ai_gimbal ? ai_data : rc_data).gimbal = slot.data.gimbal;
+    rc_data.launcher = slot.data.launcher;
+    ai_data.launcher = slot.data.launcher;
+    return true;
+  }
+#endif
+
+#if CMD_HOST_EULER_TOPIC
+  /* 仅由IMU主题回调调用；确认信息读取被打断时沿用上次锁存的值 */
+  template <typename SourceDataType>
+  void LatchHostEuler(const SourceDataType& euler, bool in_isr) {
+    const uint32_t now_us = this->NowUs();
+    if (this->host_euler_seq_.load(std::memory_order_relaxed) != 0 &&
+        now_us - this->host_euler_.sample_us < this->host_euler_period_us_) {
+      return;
+    }
+
+    const AIInput& ai = this->AIOwner(Channel::GIMBAL);
+    uint32_t ai_seq = this->host_euler_.ai_seq;
+    uint32_t ai_host_us = this->host_euler_.ai_host_us;
+    SeqLockVisit(ai.seq, ai.data, [&](const Data&) {
+      ai_seq = ai.seq.load(std::memory_order_relaxed) / 2;
+      ai_host_us = ai.host_us.load(std::memory_order_relaxed);
+    });
+
+    SeqLockWrite(this->host_euler_seq_, this->host_euler_,
+                 [&](HostEuler& slot) {
+                   CMDEulerTraits<SourceDataType>::Convert(euler, slot);
+                   slot.sample_us = now_us;
+                   slot.ai_seq = ai_seq;
+                   slot.ai_host_us = ai_host_us;
+                 });
+    this->host_euler_data_tp_.PublishFromCallback(this->host_euler_, in_isr);
+  }
+#endif
+
+#if CMD_FRAME_META
+  /* 写入时刻与快照分开读取，可能比快照新一次写入，误差不超过一个输入周期 */
+  void FillFrameMeta(CMDMeta& meta, bool ai_chassis, bool ai_gimbal,
+                     size_t rc_selected, uint32_t now_us) const {
+    const uint32_t rc_arrival_us =
+        rc_selected < RCInputArbiter::INPUT_NUM
+            ? this->rc_arrival_us_[rc_selected].load(std::memory_order_relaxed)
+            : now_us;
+    meta.chassis_arrival_us =
+        ai_chassis ? this->AIOwner(Channel::CHASSIS)
+                         .arrival_us.load(std::memory_order_relaxed)
+                   : rc_arrival_us;
+    meta.gimbal_arrival_us =
+        ai_gimbal ? this->AIOwner(Channel::GIMBAL)
+                        .arrival_us.load(std::memory_order_relaxed)
+                  : rc_arrival_us;
+    meta.chassis_source = ai_chassis ? ControlSource::CTRL_SOURCE_AI
+                                     : ControlSource::CTRL_SOURCE_RC;
+    meta.gimbal_source = ai_gimbal ? ControlSource::CTRL_SOURCE_AI
+                                   : ControlSource::CTRL_SOURCE_RC;
+    meta.rc_input = static_cast<RCInputSource>(rc_selected);
+  }
+#endif
+
+#if CMD_INVARIANT_CHECK
+  /* 按输入槽的当前状态独立复核本次输出，不复用发布流程中的判断 */
+  void CheckInvariants(bool auto_ctrl, bool ai_chassis, bool ai_gimbal,
+                       size_t rc_selected, const Data& rc_data,
+                       const LauncherCMD& launcher) {
+    const AIInput& chassis_ai = this->AIOwner(Channel::CHASSIS);
+    const AIInput& gimbal_ai = this->AIOwner(Channel::GIMBAL);
+    const AIInput& launcher_ai = this->AIOwner(Channel::LAUNCHER);
+    auto ai_online = [](const AIInput& ai) {
+      return !ai.stale.load(std::memory_order_relaxed);
+    };
+    const uint32_t online_mask =
+        this->rc_online_mask_.load(std::memory_order_acquire);
+    uint32_t failed = 0;
+
+    if (launcher.isfire && auto_ctrl &&
+        !(rc_data.launcher.isfire && launcher_ai.data.launcher.isfire &&
+          launcher_ai.data.gimbal_online && ai_online(launcher_ai))) {
+      failed |= INVARIANT_AUTO_FIRE;
+    }
+    if ((ai_chassis && (!auto_ctrl || !ai_online(chassis_ai) ||
+                        !chassis_ai.data.chassis_online)) ||
+        (ai_gimbal && (!auto_ctrl || !ai_online(gimbal_ai) ||
+                       !gimbal_ai.data.gimbal_online))) {
+      failed |= INVARIANT_AI_SOURCE;
+    }
+    if (rc_selected < RCInputArbiter::INPUT_NUM
+            ? (online_mask & RCInputArbiter::Bit(rc_selected)) == 0 ||
+                  !rc_data.chassis_online
+            : rc_data.chassis_online || rc_data.launcher.isfire) {
+      failed |= INVARIANT_RC_SOURCE;
+    }
+    if (!this->edge_pending_ && this->online_ != rc_data.chassis_online) {
+      failed |= INVARIANT_ONLINE_STATE;
+    }
+
+    this->invariant_report_.checks++;
+    if (failed != 0) {
+      this->invariant_report_.violations++;
+      this->invariant_report_.failed_mask |= failed;
+      this->invariant_report_.last_process = this->counters_.process;
+    }
+  }
+#endif
+
+  void ProcessAndPublish() {
+#if CMD_LATENCY_STATS
+    const uint32_t process_begin = LatencyNow();
+#endif
+#if CMD_LOW_FOOTPRINT
+    /* 低内存配置下快照只在本次发布流程内有效 */
+    Data rc_data;
+    Data ai_data;
+#else
+    Data& rc_data =
+        this->data_[static_cast<size_t>(ControlSource::CTRL_SOURCE_RC)];
+    Data ai_offline;
+    Data& ai_data = this->AISnapshot(ai_offline);
+#endif
+
+    if (this->estop_.load(std::memory_order_acquire)) {
+      return;
+    }
+
+    /* 输入槽快照直接读入data_，读取被打断时放弃本次发布 */
+    this->counters_.process++;
+    size_t rc_selected = RCInputArbiter::INPUT_NUM;
+#if CMD_CAN_BRIDGE
+    const bool mirror = this->bridge_role_ == BridgeRole::MIRROR;
+    const bool read_ok =
+        mirror ? this->ReadBridgeData(rc_data, ai_data)
+               : this->SelectRCData(rc_data, rc_selected) &&
+                     this->ReadAIData(ai_data);
+#else
+    const bool read_ok =
+        this->SelectRCData(rc_data, rc_selected) && this->ReadAIData(ai_data);
+#endif
+    if (!read_ok) {
+      this->counters_.aborted++;
+      return;
+    }
+
+    const uint32_t now_us = this->NowUs();
+    this->UpdateOnline(rc_data.chassis_online, now_us);
+#if CMD_LATENCY_STATS
+    const uint32_t publish_begin = LatencyNow();
+#endif
+
+    /* 直接从快照选择输出，仅发射命令需要合成 */
+    const bool auto_ctrl = this->GetCtrlMode() == Mode::CMD_AUTO_CTRL;
+    const bool ai_chassis = auto_ctrl && ai_data.chassis_online;
+    const bool ai_gimbal = auto_ctrl && ai_data.gimbal_online;
+    ChassisCMD& chassis = ai_chassis ? ai_data.chassis : rc_data.chassis;
+    GimbalCMD& gimbal = ai_gimbal ? ai_data.gimbal : rc_data.gimbal;
+    if (ai_gimbal && this->ai_predict_horizon_us_ != 0) {
+      /* 快照每次发布前重新读取，可直接在快照上外推 */
+      this->PredictAIGimbal(gimbal, now_us);
+    }
+    /* 快照上的修改不会写回输入槽 */
+#if CMD_INPUT_FILTER
+    if (this->filter_enabled_) {
+      this->ApplyFilters(chassis, gimbal, now_us);
+    }
+#endif
+    this->ApplyBumpless(this->gimbal_bumpless_, ai_gimbal, gimbal.yaw,
+                        gimbal.pit, gimbal.rol, now_us);
+    this->ApplyBumpless(this->chassis_bumpless_, ai_chassis, chassis.x,
+                        chassis.y, chassis.z, now_us);
+    LauncherCMD launcher = rc_data.launcher;
+    if (auto_ctrl) {
+      /* CMD_AUTO_CTRL 下需遥控与在线的AI同时请求才开火，AI请求已按在线状态过滤 */
+      launcher.isfire = ai_data.launcher.isfire && rc_data.launcher.isfire;
+    }
+#if CMD_INVARIANT_CHECK && CMD_CAN_BRIDGE
+    if (!mirror) {
+      this->CheckInvariants(auto_ctrl, ai_chassis, ai_gimbal, rc_selected,
+                            rc_data, launcher);
+    }
+#elif CMD_INVARIANT_CHECK
+    this->CheckInvariants(auto_ctrl, ai_chassis, ai_gimbal, rc_selected,
+                          rc_data, launcher);
+#endif
+
+    if (!this->bundle_only_) {
+      this->PublishChannel(this->gimbal_data_tp_, gimbal, this->gimbal_cache_,
+                           now_us);
+      this->PublishChannel(this->chassis_data_tp_, chassis,
+                           this->chassis_cache_, now_us);
+      this->PublishChannel(this->fire_data_tp_, launcher,
+                           this->launcher_cache_, now_us);
+    }
+
+    const bool out_chassis_online = ai_chassis || rc_data.chassis_online;
+    const bool out_gimbal_online = ai_gimbal || rc_data.gimbal_online;
+    const ControlSource out_source = (ai_chassis || ai_gimbal)
+                                         ? ControlSource::CTRL_SOURCE_AI
+                                         : ControlSource::CTRL_SOURCE_RC;
+    if (this->bundle_enabled_) {
+      this->bundle_.gimbal = gimbal;
+      this->bundle_.chassis = chassis;
+      this->bundle_.launcher = launcher;
+      this->bundle_.chassis_online = out_chassis_online;
+      this->bundle_.gimbal_online = out_gimbal_online;
+      this->bundle_.ctrl_source = out_source;
+#if CMD_FRAME_META
+      this->FillFrameMeta(this->bundle_.meta, ai_chassis, ai_gimbal,
+                          rc_selected, now_us);
+#endif
+      this->bundle_.seq++;
+      this->bundle_tp_.Publish(this->bundle_);
+      this->counters_.published++;
+    }
+
+#if CMD_QUANTIZED_TOPIC
+    if (this->quant_enabled_) {
+      QCMDFrame frame{EncodeGimbal(gimbal, this->quant_scale_),
+                      EncodeChassis(chassis, this->quant_scale_),
+                      launcher,
+                      out_chassis_online,
+                      out_gimbal_online,
+                      out_source,
+                      ++this->quant_seq_};
+      this->quant_tp_.Publish(frame);
+      this->counters_.published++;
+    }
+#endif
+
+#if CMD_CAN_BRIDGE
+    if (this->bridge_role_ == BridgeRole::AUTHORITY) {
+      this->SendBridgeFrames(gimbal, chassis, launcher, rc_data, auto_ctrl,
+                             ai_chassis, ai_gimbal, now_us);
+    }
+#endif
+
+#if CMD_RECORDER
+    this->AppendRecord(RecordType::PUBLISH, static_cast<uint8_t>(rc_selected),
+                       this->counters_.process,
+                       Data{gimbal, chassis, launcher, out_chassis_online,
+                            out_gimbal_online, out_source},
+                       now_us);
+#endif
+
+    /* 发布期间被紧急停止抢占，覆盖本次已发布的命令 */
+    if (this->estop_.load(std::memory_order_acquire)) {
+      this->PublishStop(false);
+    }
+
+#if CMD_LATENCY_STATS
+    this->RecordLatency(process_begin, publish_begin);
+#endif
+  }
+};
+
+using CMD = BasicCMD<CMD_POLICY>;
+
+#if CMD_LOW_FOOTPRINT
+static_assert(sizeof(CMD) <= CMD_FOOTPRINT_BUDGET,
+              "CMD exceeds CMD_FOOTPRINT_BUDGET in the low-footprint profile");
+#endif
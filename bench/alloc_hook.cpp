@@ -0,0 +1,29 @@
+/**
+ * @file alloc_hook.cpp
+ * @brief 替换全局 operator new / delete，统计堆分配次数
+ * @details 主机基准默认链接；嵌入式目标需要统计时将本文件加入固件
+ */
+
+#include <cstdlib>
+#include <new>
+
+#include "cmd_bench.hpp"
+
+void* operator new(std::size_t size) {
+  CMDBench::alloc_count.fetch_add(1, std::memory_order_relaxed);
+  void* ptr = std::malloc(size == 0 ? 1 : size);
+  if (ptr == nullptr) {
+    std::abort();
+  }
+  return ptr;
+}
+
+void* operator new[](std::size_t size) { return operator new(size); }
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+
+void operator delete[](void* ptr) noexcept { std::free(ptr); }
+
+void operator delete(void* ptr, std::size_t) noexcept { std::free(ptr); }
+
+void operator delete[](void* ptr, std::size_t) noexcept { std::free(ptr); }
@@ -0,0 +1,268 @@
+#pragma once
+
+/**
+ * @file cmd_bench.hpp
+ * @brief CMD 热路径基准场景
+ * @details 主机与嵌入式目标共用。Cortex-M 上以 DWT 周期计时，
+ *          其他平台以纳秒计时；仿真时钟经 SetClock 注入，结果与真实时间无关
+ */
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+#include "CMD.hpp"
+
+#if defined(__ARM_ARCH_7M__) || defined(__ARM_ARCH_7EM__) || \
+    defined(__ARM_ARCH_8M_MAIN__)
+#define CMD_BENCH_USE_DWT 1
+#else
+#include <chrono>
+#define CMD_BENCH_USE_DWT 0
+#endif
+
+namespace CMDBench {
+
+/**
+ * @brief 堆分配计数
+ * @details 由 alloc_hook.cpp 中替换的全局 operator new 累加，
+ *          未链接该文件时恒为0
+ */
+inline std::atomic<uint32_t> alloc_count{0};
+
+/**
+ * @brief 单个场景的测量结果
+ */
+struct Result {
+  const char* name;   /* 场景名 */
+  uint32_t feeds;     /* 输入写入次数 */
+  uint32_t published; /* 实际 Publish 调用次数 */
+  uint32_t allocs;    /* 计时区间内的堆分配次数 */
+  uint64_t ticks;     /* 计时区间耗时，单位见 TICK_UNIT */
+};
+
+/**
+ * @brief 计时单位
+ */
+constexpr const char* TICK_UNIT = CMD_BENCH_USE_DWT ? "cycles" : "ns";
+
+/**
+ * @brief 计时器读数
+ * @details DWT 为32位计数器，按回绕计算差值，单个场景的耗时不得超过
+ *          一个回绕周期
+ */
+#if CMD_BENCH_USE_DWT
+using Tick = uint32_t;
+#else
+using Tick = uint64_t;
+#endif
+
+/**
+ * @brief 读取计时器
+ */
+inline Tick Now() {
+#if CMD_BENCH_USE_DWT
+  constexpr uintptr_t DWT_CYCCNT_ADDR = 0xE0001004;
+  return *reinterpret_cast<volatile uint32_t*>(DWT_CYCCNT_ADDR);
+#else
+  return static_cast<Tick>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+          std::chrono::steady_clock::now().time_since_epoch())
+          .count());
+#endif
+}
+
+/**
+ * @brief 使能计时器
+ * @details Cortex-M7 需先写 LAR 解锁 DWT 寄存器，否则 CYCCNT 保持为0
+ */
+inline void EnableTimer() {
+#if CMD_BENCH_USE_DWT
+  constexpr uintptr_t DEMCR_ADDR = 0xE000EDFC;
+  constexpr uintptr_t DWT_CTRL_ADDR = 0xE0001000;
+  constexpr uintptr_t DWT_LAR_ADDR = 0xE0001FB0;
+  constexpr uint32_t DWT_LAR_KEY = 0xC5ACCE55;
+  *reinterpret_cast<volatile uint32_t*>(DEMCR_ADDR) |= (1u << 24);
+  *reinterpret_cast<volatile uint32_t*>(DWT_LAR_ADDR) = DWT_LAR_KEY;
+  *reinterpret_cast<volatile uint32_t*>(DWT_CTRL_ADDR) |= 1u;
+#endif
+}
+
+/**
+ * @brief 场景共用的仿真时钟与计时区间
+ */
+class Scenario {
+ public:
+  Scenario(const char* name, CMD& cmd) : cmd_(cmd) {
+    this->result_.name = name;
+    this->cmd_.SetClock(Clock, this);
+  }
+
+  /**
+   * @brief 推进仿真时间
+   */
+  void Advance(uint32_t us) { this->now_us_ += us; }
+
+  /**
+   * @brief 开始计时，记录计数基准
+   */
+  void Begin() {
+    this->base_ = this->cmd_.GetPublishCounters();
+    this->allocs_ = alloc_count.load(std::memory_order_relaxed);
+    this->start_ = Now();
+  }
+
+  /**
+   * @brief 结束计时，返回计数差值
+   */
+  Result End() {
+    const Tick stop = Now();
+    const CMD::PublishCounters counters = this->cmd_.GetPublishCounters();
+    this->result_.ticks = stop - this->start_;
+    this->result_.allocs =
+        alloc_count.load(std::memory_order_relaxed) - this->allocs_;
+    this->result_.feeds = counters.feeds - this->base_.feeds;
+    this->result_.published = counters.published - this->base_.published;
+    return this->result_;
+  }
+
+ private:
+  static uint32_t Clock(void* arg) {
+    return static_cast<Scenario*>(arg)->now_us_;
+  }
+
+  CMD& cmd_;
+  uint32_t now_us_ = 1;
+  Tick start_ = 0;
+  uint32_t allocs_ = 0;
+  CMD::PublishCounters base_{};
+  Result result_{};
+};
+
+/* 遥控输入，x 随步数变化以免被变化检测跳过 */
+inline CMD::Data MakeRC(uint32_t step, bool online) {
+  CMD::Data data{};
+  data.chassis_online = online;
+  data.gimbal_online = online;
+  data.chassis.x = static_cast<float>(step % 100) * 0.01f;
+  data.gimbal.yaw = static_cast<float>(step % 360) * 0.01f;
+  data.launcher.isfire = (step & 1u) != 0;
+  return data;
+}
+
+/**
+ * @brief 单遥控源同步发布
+ */
+inline Result SingleRC(LibXR::HardwareContainer& hw,
+                       LibXR::ApplicationManager& app, uint32_t steps) {
+  CMD cmd(hw, app, CMD::Mode::CMD_OP_CTRL, "bench_single_chassis",
+          "bench_single_gimbal", "bench_single_launcher");
+  Scenario scenario("single_rc", cmd);
+  scenario.Begin();
+  for (uint32_t i = 0; i < steps; i++) {
+    scenario.Advance(1000);
+    cmd.FeedRC(CMD::RCInputSource::RC_INPUT_DR16, MakeRC(i, true));
+  }
+  return scenario.End();
+}
+
+/**
+ * @brief DR16 / VT13 双源，DR16 在线状态每50步切换一次
+ */
+inline Result DualRCFlap(LibXR::HardwareContainer& hw,
+                         LibXR::ApplicationManager& app, uint32_t steps) {
+  CMD cmd(hw, app, CMD::Mode::CMD_OP_CTRL, "bench_flap_chassis",
+          "bench_flap_gimbal", "bench_flap_launcher");
+  Scenario scenario("dual_rc_flap", cmd);
+  scenario.Begin();
+  for (uint32_t i = 0; i < steps; i++) {
+    scenario.Advance(500);
+    if ((i & 1u) == 0) {
+      cmd.FeedRC(CMD::RCInputSource::RC_INPUT_DR16,
+                 MakeRC(i, (i / 50) % 2 == 0));
+    } else {
+      cmd.FeedRC(CMD::RCInputSource::RC_INPUT_VT13, MakeRC(i, true));
+    }
+  }
+  return scenario.End();
+}
+
+/**
+ * @brief CMD_AUTO_CTRL 下 AI 以 1 kHz 写入，遥控约 70 Hz
+ */
+inline Result AutoAI(LibXR::HardwareContainer& hw,
+                     LibXR::ApplicationManager& app, uint32_t steps) {
+  CMD cmd(hw, app, CMD::Mode::CMD_AUTO_CTRL, "bench_ai_chassis",
+          "bench_ai_gimbal", "bench_ai_launcher");
+  Scenario scenario("auto_ai_1khz", cmd);
+  scenario.Begin();
+  for (uint32_t i = 0; i < steps; i++) {
+    scenario.Advance(1000);
+    if (i % 14 == 0) {
+      cmd.FeedRC(CMD::RCInputSource::RC_INPUT_DR16, MakeRC(i, true));
+    }
+    CMD::Data ai = MakeRC(i, true);
+    ai.gimbal.yaw_dot = 0.5f;
+    cmd.FeedAI(ai);
+  }
+  return scenario.End();
+}
+
+/**
+ * @brief 遥控与 AI 同时写入，每20步切换一次控制模式
+ */
+inline Result ModeSwitch(LibXR::HardwareContainer& hw,
+                         LibXR::ApplicationManager& app, uint32_t steps) {
+  CMD cmd(hw, app, CMD::Mode::CMD_OP_CTRL, "bench_mode_chassis",
+          "bench_mode_gimbal", "bench_mode_launcher");
+  Scenario scenario("mode_switch", cmd);
+  scenario.Begin();
+  for (uint32_t i = 0; i < steps; i++) {
+    scenario.Advance(1000);
+    if (i % 20 == 0) {
+      cmd.SetCtrlMode((i / 20) % 2 == 0 ? CMD::Mode::CMD_AUTO_CTRL
+                                        : CMD::Mode::CMD_OP_CTRL);
+    }
+    if ((i & 1u) == 0) {
+      cmd.FeedRC(CMD::RCInputSource::RC_INPUT_DR16, MakeRC(i, true));
+    } else {
+      cmd.FeedAI(MakeRC(i, true));
+    }
+  }
+  return scenario.End();
+}
+
+constexpr size_t SCENARIO_NUM = 4;
+
+/**
+ * @brief 依次运行全部场景
+ * @param steps 每个场景的步数，嵌入式目标上应保证单个场景不超过一个
+ *              DWT 回绕周期
+ */
+inline std::array<Result, SCENARIO_NUM> RunAll(LibXR::HardwareContainer& hw,
+                                               LibXR::ApplicationManager& app,
+                                               uint32_t steps) {
+  EnableTimer();
+  return {SingleRC(hw, app, steps), DualRCFlap(hw, app, steps),
+          AutoAI(hw, app, steps), ModeSwitch(hw, app, steps)};
+}
+
+/**
+ * @brief 每次写入的平均耗时，单位见 TICK_UNIT
+ */
+inline double TicksPerFeed(const Result& result) {
+  return result.feeds == 0 ? 0.0
+                           : static_cast<double>(result.ticks) / result.feeds;
+}
+
+/**
+ * @brief 每秒发布次数
+ * @param tick_hz 计时器频率，主机上为 1e9，Cortex-M 上为内核时钟频率
+ */
+inline double PublishesPerSecond(const Result& result, double tick_hz) {
+  return result.ticks == 0
+             ? 0.0
+             : static_cast<double>(result.published) * tick_hz / result.ticks;
+}
+
+}  // namespace CMDBench
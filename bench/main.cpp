@@ -0,0 +1,30 @@
+/**
+ * @file main.cpp
+ * @brief CMD 热路径主机基准
+ * @details 用法：cmd_bench [每个场景的步数]，默认 1000000
+ */
+
+#include <cstdio>
+#include <cstdlib>
+
+#include "cmd_bench.hpp"
+#include "libxr.hpp"
+
+int main(int argc, char** argv) {
+  const uint32_t steps =
+      argc > 1 ? static_cast<uint32_t>(std::strtoul(argv[1], nullptr, 10))
+               : 1000000u;
+
+  LibXR::PlatformInit();
+  LibXR::HardwareContainer hw;
+  LibXR::ApplicationManager app;
+
+  std::printf("%-14s %12s %10s %14s %8s\n", "scenario", "feeds", "ns/feed",
+              "publishes/s", "allocs");
+  for (const CMDBench::Result& result : CMDBench::RunAll(hw, app, steps)) {
+    std::printf("%-14s %12u %10.1f %14.0f %8u\n", result.name, result.feeds,
+                CMDBench::TicksPerFeed(result),
+                CMDBench::PublishesPerSecond(result, 1e9), result.allocs);
+  }
+  return 0;
+}
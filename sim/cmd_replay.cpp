@@ -0,0 +1,187 @@
+/**
+ * @file cmd_replay.cpp
+ * @brief 飞行记录主机回放工具
+ * @details 读取 DrainRecords 导出的原始 Record 序列，按顺序回放到配置相同的
+ *          CMD 实例，并将其产生的 PUBLISH 记录与原记录逐条比较。
+ *
+ *          用法：cmd_replay [-p publish_period_ms] [-s stale_timeout_ms]
+ *                           [-e event_dwell_ms] [-a] <log>
+ *          -a 表示记录开始时处于 CMD_AUTO_CTRL。发布结果全部一致时返回0。
+ */
+
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "CMD.hpp"
+#include "libxr.hpp"
+
+static_assert(CMD_RECORDER, "cmd_replay requires CMD_RECORDER=1");
+
+namespace {
+
+struct Options {
+  uint32_t publish_period_ms = 0;
+  uint32_t stale_timeout_ms = 0;
+  uint32_t event_dwell_ms = 0;
+  CMD::Mode mode = CMD::Mode::CMD_OP_CTRL;
+  const char* path = nullptr;
+};
+
+bool ParseOptions(int argc, char** argv, Options& options) {
+  for (int i = 1; i < argc; i++) {
+    if (std::strcmp(argv[i], "-p") == 0 && i + 1 < argc) {
+      options.publish_period_ms = std::strtoul(argv[++i], nullptr, 10);
+    } else if (std::strcmp(argv[i], "-s") == 0 && i + 1 < argc) {
+      options.stale_timeout_ms = std::strtoul(argv[++i], nullptr, 10);
+    } else if (std::strcmp(argv[i], "-e") == 0 && i + 1 < argc) {
+      options.event_dwell_ms = std::strtoul(argv[++i], nullptr, 10);
+    } else if (std::strcmp(argv[i], "-a") == 0) {
+      options.mode = CMD::Mode::CMD_AUTO_CTRL;
+    } else if (argv[i][0] != '-' && options.path == nullptr) {
+      options.path = argv[i];
+    } else {
+      return false;
+    }
+  }
+  return options.path != nullptr;
+}
+
+bool LoadRecords(const char* path, std::vector<CMD::Record>& records) {
+  std::FILE* file = std::fopen(path, "rb");
+  if (file == nullptr) {
+    std::perror(path);
+    return false;
+  }
+  CMD::Record record;
+  while (std::fread(&record, sizeof(record), 1, file) == 1) {
+    records.push_back(record);
+  }
+  const bool truncated = std::fgetc(file) != EOF || !std::feof(file);
+  std::fclose(file);
+  if (truncated) {
+    std::fprintf(stderr, "%s: trailing bytes, not a Record dump\n", path);
+    return false;
+  }
+  return true;
+}
+
+/* 逐字段比较发布结果，不比较 Data 尾部填充；同步模式下原记录的发布时刻
+ * 晚于触发它的输入记录，回放以输入时刻发布，因此不比较记录时刻 */
+bool SameOutput(const CMD::Record& a, const CMD::Record& b) {
+  return a.arg == b.arg &&
+         std::memcmp(&a.data.gimbal, &b.data.gimbal,
+                     sizeof(CMD::GimbalCMD)) == 0 &&
+         std::memcmp(&a.data.chassis, &b.data.chassis,
+                     offsetof(CMD::ChassisCMD, self_define)) == 0 &&
+         a.data.chassis.self_define == b.data.chassis.self_define &&
+         a.data.launcher.isfire == b.data.launcher.isfire &&
+         a.data.chassis_online == b.data.chassis_online &&
+         a.data.gimbal_online == b.data.gimbal_online &&
+         a.data.ctrl_source == b.data.ctrl_source;
+}
+
+void PrintOutput(const char* tag, const CMD::Record& record) {
+  std::fprintf(stderr,
+               "  %s t=%u rc=%u online=%d/%d src=%u x=%g y=%g z=%g "
+               "yaw=%g pit=%g fire=%d\n",
+               tag, record.time_us, record.arg, record.data.chassis_online,
+               record.data.gimbal_online,
+               static_cast<unsigned>(record.data.ctrl_source),
+               record.data.chassis.x, record.data.chassis.y,
+               record.data.chassis.z, record.data.gimbal.yaw,
+               record.data.gimbal.pit, record.data.launcher.isfire);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  Options options;
+  if (!ParseOptions(argc, argv, options)) {
+    std::fprintf(stderr,
+                 "usage: %s [-p publish_period_ms] [-s stale_timeout_ms] "
+                 "[-e event_dwell_ms] [-a] <log>\n",
+                 argv[0]);
+    return 2;
+  }
+
+  std::vector<CMD::Record> log;
+  if (!LoadRecords(options.path, log)) {
+    return 2;
+  }
+
+  uint32_t gaps = 0;
+  for (size_t i = 1; i < log.size(); i++) {
+    if (static_cast<uint16_t>(log[i - 1].index + 1) != log[i].index) {
+      gaps++;
+    }
+  }
+
+  LibXR::PlatformInit();
+  LibXR::HardwareContainer hw;
+  LibXR::ApplicationManager app;
+  CMD cmd(hw, app, options.mode, "replay_chassis", "replay_gimbal",
+          "replay_launcher", options.publish_period_ms);
+  cmd.SetExternalTick(true);
+  cmd.SetStaleTimeout(options.stale_timeout_ms);
+  cmd.SetEventPolicy(options.event_dwell_ms, false);
+
+  /* 回放实例先导出一次，丢弃构造期间的记录 */
+  std::array<CMD::Record, CMD_RECORDER_SIZE> drained{};
+  cmd.DrainRecords(drained.data(), drained.size());
+
+  size_t expected = 0;
+  uint32_t compared = 0;
+  uint32_t mismatched = 0;
+  uint32_t extra = 0;
+  auto next_expected = [&]() -> const CMD::Record* {
+    while (expected < log.size() &&
+           log[expected].type != CMD::RecordType::PUBLISH) {
+      expected++;
+    }
+    return expected < log.size() ? &log[expected++] : nullptr;
+  };
+
+  const auto start = std::chrono::steady_clock::now();
+  for (const CMD::Record& record : log) {
+    cmd.Replay(record);
+    const size_t count = cmd.DrainRecords(drained.data(), drained.size());
+    for (size_t i = 0; i < count; i++) {
+      if (drained[i].type != CMD::RecordType::PUBLISH) {
+        continue;
+      }
+      const CMD::Record* want = next_expected();
+      if (want == nullptr) {
+        extra++;
+        continue;
+      }
+      compared++;
+      if (!SameOutput(*want, drained[i])) {
+        if (mismatched < 8) {
+          std::fprintf(stderr, "mismatch at record %u:\n", want->index);
+          PrintOutput("log   ", *want);
+          PrintOutput("replay", drained[i]);
+        }
+        mismatched++;
+      }
+    }
+  }
+  const double seconds = std::chrono::duration<double>(
+                             std::chrono::steady_clock::now() - start)
+                             .count();
+
+  uint32_t missing = 0;
+  while (next_expected() != nullptr) {
+    missing++;
+  }
+
+  std::printf(
+      "records=%zu gaps=%u publishes=%u mismatched=%u missing=%u extra=%u "
+      "dropped=%u %.0f records/s\n",
+      log.size(), gaps, compared, mismatched, missing, extra,
+      cmd.GetRecorderDropped(), seconds > 0.0 ? log.size() / seconds : 0.0);
+  return mismatched == 0 && missing == 0 && extra == 0 ? 0 : 1;
+}
@@ -0,0 +1,413 @@
+/**
+ * @file cmd_sim.cpp
+ * @brief CMD 仲裁逻辑主机仿真
+ * @details 以注入的仿真时钟最快速度驱动 CMD：先运行脚本序列并逐步断言发布
+ *          结果，再运行随机序列并检查不变量报告，最后输出吞吐量。任一断言
+ *          失败或违反不变量时返回非零，可直接用于每日构建。
+ *
+ *          用法：cmd_sim [-n 随机步数] [-r 随机种子] [-d 记录导出文件]
+ *          导出文件可交给 cmd_replay -s 20 -a 回放核对。
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "CMD.hpp"
+#include "libxr.hpp"
+
+static_assert(CMD_INVARIANT_CHECK, "cmd_sim requires CMD_INVARIANT_CHECK=1");
+static_assert(CMD_RECORDER, "cmd_sim requires CMD_RECORDER=1");
+
+namespace {
+
+using RC = CMD::RCInputSource;
+using Mode = CMD::Mode;
+
+constexpr uint32_t STALE_TIMEOUT_MS = 20;
+constexpr uint8_t NO_RC = static_cast<uint8_t>(RC::RC_INPUT_NUM);
+
+uint32_t failures = 0;
+
+/**
+ * @brief 单个 CMD 实例的仿真环境
+ * @details 仿真时钟只在 Advance 时推进；每次驱动后导出记录，
+ *          最近一条 PUBLISH 记录即为当前输出
+ */
+class Sim {
+ public:
+  Sim(LibXR::HardwareContainer& hw, LibXR::ApplicationManager& app,
+      const char* name, Mode mode)
+      : name_(name),
+        chassis_(std::string("sim_") + name + "_chassis"),
+        gimbal_(std::string("sim_") + name + "_gimbal"),
+        launcher_(std::string("sim_") + name + "_launcher"),
+        cmd(hw, app, mode, chassis_.c_str(), gimbal_.c_str(),
+            launcher_.c_str()) {
+    this->cmd.SetClock(Clock, this);
+    this->cmd.SetStaleTimeout(STALE_TIMEOUT_MS);
+    auto counter = LibXR::Callback<uint32_t>::Create(
+        [](bool in_isr, Sim* sim, uint32_t event_id) {
+          UNUSED(in_isr);
+          if (event_id == CMD::CMD_EVENT_START_CTRL) {
+            sim->start_events++;
+          } else {
+            sim->lost_events++;
+          }
+        },
+        this);
+    this->cmd.GetEvent().Register(CMD::CMD_EVENT_START_CTRL, counter);
+    this->cmd.GetEvent().Register(CMD::CMD_EVENT_LOST_CTRL, counter);
+  }
+
+  void Advance(uint32_t ms) { this->now_us_ += ms * 1000; }
+
+  void FeedRC(RC source, bool online, float x, bool fire) {
+    CMD::Data data{};
+    data.chassis_online = online;
+    data.gimbal_online = online;
+    data.chassis.x = x;
+    data.launcher.isfire = fire;
+    this->cmd.FeedRC(source, data);
+    this->Drain();
+  }
+
+  void FeedAI(bool chassis_online, bool gimbal_online, float x, bool fire) {
+    CMD::Data data{};
+    data.chassis_online = chassis_online;
+    data.gimbal_online = gimbal_online;
+    data.chassis.x = x;
+    data.launcher.isfire = fire;
+    this->cmd.FeedAI(data);
+    this->Drain();
+  }
+
+  void Monitor() {
+    this->cmd.OnMonitor();
+    this->Drain();
+  }
+
+  void SetMode(Mode mode) {
+    this->cmd.SetCtrlMode(mode);
+    this->Drain();
+  }
+
+  /**
+   * @brief 断言最近一次发布的结果
+   * @param rc 选中的遥控输入源，NO_RC 表示无在线遥控输入源
+   */
+  void Expect(const char* what, uint8_t rc, CMD::ControlSource source,
+              bool online, float x, bool fire) {
+    const CMD::Data& out = this->last_.data;
+    Check(this->published_ && this->last_.arg == rc &&
+              out.ctrl_source == source && out.chassis_online == online &&
+              out.chassis.x == x && out.launcher.isfire == fire,
+          what);
+  }
+
+  void Check(bool ok, const char* what) {
+    if (ok) {
+      return;
+    }
+    const CMD::Data& out = this->last_.data;
+    std::fprintf(stderr,
+                 "%s: %s failed at t=%u ms (rc=%u src=%u online=%d x=%g "
+                 "fire=%d)\n",
+                 this->name_, what, this->now_us_ / 1000, this->last_.arg,
+                 static_cast<unsigned>(out.ctrl_source), out.chassis_online,
+                 out.chassis.x, out.launcher.isfire);
+    failures++;
+  }
+
+  /**
+   * @brief 断言本实例未违反不变量
+   */
+  void CheckInvariants() {
+    const CMD::InvariantReport& report = this->cmd.GetInvariantReport();
+    if (report.checks == 0 || report.violations != 0) {
+      std::fprintf(stderr, "%s: %u of %u invariant checks failed, mask=%#x\n",
+                   this->name_, report.violations, report.checks,
+                   report.failed_mask);
+      failures++;
+    }
+  }
+
+ private:
+  static uint32_t Clock(void* arg) { return static_cast<Sim*>(arg)->now_us_; }
+
+  void Drain() {
+    std::array<CMD::Record, CMD_RECORDER_SIZE> records;
+    const size_t count = this->cmd.DrainRecords(records.data(), records.size());
+    for (size_t i = 0; i < count; i++) {
+      if (records[i].type == CMD::RecordType::PUBLISH) {
+        this->last_ = records[i];
+        this->published_ = true;
+      }
+    }
+  }
+
+  const char* name_;
+  std::string chassis_;
+  std::string gimbal_;
+  std::string launcher_;
+  uint32_t now_us_ = 1;
+  CMD::Record last_{};
+  bool published_ = false;
+
+ public:
+  CMD cmd;
+  uint32_t start_events = 0;
+  uint32_t lost_events = 0;
+};
+
+constexpr auto SRC_RC = CMD::ControlSource::CTRL_SOURCE_RC;
+constexpr auto SRC_AI = CMD::ControlSource::CTRL_SOURCE_AI;
+constexpr auto DR16 = static_cast<uint8_t>(RC::RC_INPUT_DR16);
+constexpr auto VT13 = static_cast<uint8_t>(RC::RC_INPUT_VT13);
+
+/* DR16 掉线后切换到 VT13，全部掉线后输出离线命令 */
+void ScriptRCFailover(LibXR::HardwareContainer& hw,
+                      LibXR::ApplicationManager& app) {
+  Sim sim(hw, app, "rc_failover", Mode::CMD_OP_CTRL);
+  sim.FeedRC(RC::RC_INPUT_DR16, true, 0.5f, true);
+  sim.Expect("DR16 online", DR16, SRC_RC, true, 0.5f, true);
+  sim.Advance(5);
+  sim.FeedRC(RC::RC_INPUT_VT13, true, 0.0f, false);
+  sim.Expect("DR16 kept while VT13 idle", DR16, SRC_RC, true, 0.5f, true);
+
+  /* 只有 VT13 继续写入，DR16 超时 */
+  for (int i = 0; i < 6; i++) {
+    sim.Advance(5);
+    sim.FeedRC(RC::RC_INPUT_VT13, true, 0.0f, false);
+    sim.Monitor();
+  }
+  sim.Expect("failover to VT13", VT13, SRC_RC, true, 0.0f, false);
+
+  /* VT13 也停止写入 */
+  sim.Advance(STALE_TIMEOUT_MS + 5);
+  sim.Monitor();
+  sim.Expect("all RC lost", NO_RC, SRC_RC, false, 0.0f, false);
+  sim.Check(!sim.cmd.Online(), "offline after all RC lost");
+
+  /* DR16 恢复 */
+  sim.Advance(1);
+  sim.FeedRC(RC::RC_INPUT_DR16, true, 0.25f, false);
+  sim.Expect("DR16 back", DR16, SRC_RC, true, 0.25f, false);
+  sim.CheckInvariants();
+}
+
+/* CMD_AUTO_CTRL 下开火需遥控与在线的 AI 同时请求 */
+void ScriptAutoFire(LibXR::HardwareContainer& hw,
+                    LibXR::ApplicationManager& app) {
+  Sim sim(hw, app, "auto_fire", Mode::CMD_AUTO_CTRL);
+  sim.FeedRC(RC::RC_INPUT_DR16, true, 0.5f, true);
+  sim.Expect("no AI, no fire", DR16, SRC_RC, true, 0.5f, false);
+  sim.Advance(1);
+  sim.FeedAI(true, true, 0.75f, false);
+  sim.Expect("AI holds fire", DR16, SRC_AI, true, 0.75f, false);
+  sim.Advance(1);
+  sim.FeedAI(true, true, 0.75f, true);
+  sim.Expect("RC and AI fire", DR16, SRC_AI, true, 0.75f, true);
+  sim.Advance(1);
+  sim.FeedRC(RC::RC_INPUT_DR16, true, 0.5f, false);
+  sim.Expect("RC releases trigger", DR16, SRC_AI, true, 0.75f, false);
+  sim.Advance(1);
+  sim.FeedRC(RC::RC_INPUT_DR16, true, 0.5f, true);
+  sim.FeedAI(true, false, 0.75f, true);
+  sim.Expect("AI gimbal offline", DR16, SRC_AI, true, 0.75f, false);
+  sim.Advance(1);
+  sim.FeedAI(true, true, 0.75f, true);
+  sim.Expect("AI gimbal back", DR16, SRC_AI, true, 0.75f, true);
+
+  /* 只有遥控继续写入，AI 超时 */
+  for (int i = 0; i < 6; i++) {
+    sim.Advance(5);
+    sim.FeedRC(RC::RC_INPUT_DR16, true, 0.5f, true);
+    sim.Monitor();
+  }
+  sim.Expect("stale AI blocks fire", DR16, SRC_RC, true, 0.5f, false);
+
+  sim.SetMode(Mode::CMD_OP_CTRL);
+  sim.Expect("operator fires alone", DR16, SRC_RC, true, 0.5f, true);
+  sim.CheckInvariants();
+}
+
+/* AI 在线状态每毫秒翻转，输出随之在 AI 与遥控之间切换 */
+void ScriptAIFlap(LibXR::HardwareContainer& hw,
+                  LibXR::ApplicationManager& app) {
+  Sim sim(hw, app, "ai_flap", Mode::CMD_AUTO_CTRL);
+  sim.FeedRC(RC::RC_INPUT_DR16, true, 0.5f, true);
+  for (int i = 0; i < 200; i++) {
+    const bool ai_online = (i & 1) == 0;
+    sim.Advance(1);
+    sim.FeedAI(ai_online, ai_online, 0.75f, true);
+    if (ai_online) {
+      sim.Expect("AI online", DR16, SRC_AI, true, 0.75f, true);
+    } else {
+      sim.Expect("AI offline", DR16, SRC_RC, true, 0.5f, false);
+    }
+    if (i % 10 == 9) {
+      sim.FeedRC(RC::RC_INPUT_DR16, true, 0.5f, true);
+    }
+  }
+  sim.CheckInvariants();
+}
+
+/* 遥控在线状态每毫秒翻转，防抖期间不产生控制事件；随后的模式事件风暴
+ * 以最后一个事件为准 */
+void ScriptEventStorm(LibXR::HardwareContainer& hw,
+                      LibXR::ApplicationManager& app) {
+  Sim sim(hw, app, "event_storm", Mode::CMD_OP_CTRL);
+  sim.cmd.SetEventPolicy(5, true);
+  for (int i = 0; i < 100; i++) {
+    sim.Advance(1);
+    sim.FeedRC(RC::RC_INPUT_DR16, (i & 1) == 0, 0.5f, false);
+    sim.Monitor();
+  }
+  sim.Check(sim.start_events == 0 && sim.lost_events == 0,
+            "no events while flapping");
+
+  for (int i = 0; i < 10; i++) {
+    sim.Advance(1);
+    sim.FeedRC(RC::RC_INPUT_DR16, true, 0.5f, false);
+    sim.Monitor();
+  }
+  sim.Check(sim.start_events == 1 && sim.lost_events == 0,
+            "one START_CTRL after dwell");
+  sim.Check(sim.cmd.Online(), "online after dwell");
+
+  for (int i = 0; i < 1001; i++) {
+    sim.cmd.GetEvent().Active(
+        static_cast<uint32_t>(i % 2 ? Mode::CMD_OP_CTRL : Mode::CMD_AUTO_CTRL));
+  }
+  sim.Monitor();
+  sim.Check(sim.cmd.GetCtrlMode() == Mode::CMD_AUTO_CTRL,
+            "last mode event wins");
+  sim.CheckInvariants();
+}
+
+/* 随机序列：遥控掉线、AI 在线抖动、模式事件与节拍交错 */
+void RandomSoak(LibXR::HardwareContainer& hw, LibXR::ApplicationManager& app,
+                uint32_t steps, uint32_t seed, std::FILE* dump) {
+  Sim sim(hw, app, "random", Mode::CMD_AUTO_CTRL);
+  sim.cmd.SetEventPolicy(5, true);
+  std::mt19937 rng(seed);
+  std::array<CMD::Record, CMD_RECORDER_SIZE> records;
+  uint32_t now_us = 1;
+  uint32_t dropped = sim.cmd.GetRecorderDropped();
+
+  /* 随机序列自行推进时钟并导出记录，不经过 Sim 的脚本接口 */
+  sim.cmd.SetClock([](void* arg) { return *static_cast<uint32_t*>(arg); },
+                   &now_us);
+  const CMD::PublishCounters before = sim.cmd.GetPublishCounters();
+  const auto start = std::chrono::steady_clock::now();
+  for (uint32_t i = 0; i < steps; i++) {
+    now_us += 1 + rng() % 2000;
+    CMD::Data data{};
+    data.chassis_online = rng() % 10 != 0;
+    data.gimbal_online = data.chassis_online && rng() % 8 != 0;
+    data.chassis.x = static_cast<float>(rng() % 100) * 0.01f;
+    data.launcher.isfire = (rng() & 1) != 0;
+    switch (rng() % 7) {
+      case 0:
+        sim.cmd.FeedRC(RC::RC_INPUT_DR16, data);
+        break;
+      case 1:
+        sim.cmd.FeedRC(RC::RC_INPUT_VT13, data);
+        break;
+      case 2:
+      case 3:
+        sim.cmd.FeedAI(data);
+        break;
+      case 4:
+        sim.cmd.OnMonitor();
+        break;
+      case 5:
+        if (rng() % 32 == 0) {
+          sim.cmd.GetEvent().Active(static_cast<uint32_t>(
+              rng() & 1 ? Mode::CMD_AUTO_CTRL : Mode::CMD_OP_CTRL));
+        }
+        break;
+      default:
+        sim.cmd.PublishTick();
+        break;
+    }
+    if (dump != nullptr) {
+      const size_t count =
+          sim.cmd.DrainRecords(records.data(), records.size());
+      std::fwrite(records.data(), sizeof(CMD::Record), count, dump);
+    }
+  }
+  const double seconds = std::chrono::duration<double>(
+                             std::chrono::steady_clock::now() - start)
+                             .count();
+  const CMD::PublishCounters after = sim.cmd.GetPublishCounters();
+  const CMD::InvariantReport& report = sim.cmd.GetInvariantReport();
+  dropped = sim.cmd.GetRecorderDropped() - dropped;
+
+  std::printf(
+      "random: steps=%u seed=%u process=%u checks=%u violations=%u "
+      "mask=%#x\n",
+      steps, seed, after.process - before.process, report.checks,
+      report.violations, report.failed_mask);
+  std::printf("random: %.0f steps/s, %.0f publishes/s\n",
+              seconds > 0.0 ? steps / seconds : 0.0,
+              seconds > 0.0 ? (after.process - before.process) / seconds
+                            : 0.0);
+  if (dump != nullptr && dropped != 0) {
+    std::fprintf(stderr, "random: %u records dropped from dump\n", dropped);
+    failures++;
+  }
+  sim.CheckInvariants();
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  uint32_t steps = 1000000;
+  uint32_t seed = 1;
+  const char* dump_path = nullptr;
+  for (int i = 1; i < argc; i++) {
+    if (std::strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+      steps = std::strtoul(argv[++i], nullptr, 10);
+    } else if (std::strcmp(argv[i], "-r") == 0 && i + 1 < argc) {
+      seed = std::strtoul(argv[++i], nullptr, 10);
+    } else if (std::strcmp(argv[i], "-d") == 0 && i + 1 < argc) {
+      dump_path = argv[++i];
+    } else {
+      std::fprintf(stderr, "usage: %s [-n steps] [-r seed] [-d dump]\n",
+                   argv[0]);
+      return 2;
+    }
+  }
+
+  LibXR::PlatformInit();
+  LibXR::HardwareContainer hw;
+  LibXR::ApplicationManager app;
+
+  ScriptRCFailover(hw, app);
+  ScriptAutoFire(hw, app);
+  ScriptAIFlap(hw, app);
+  ScriptEventStorm(hw, app);
+  std::printf("scripted: %u failures\n", failures);
+
+  std::FILE* dump = nullptr;
+  if (dump_path != nullptr) {
+    dump = std::fopen(dump_path, "wb");
+    if (dump == nullptr) {
+      std::perror(dump_path);
+      return 2;
+    }
+  }
+  RandomSoak(hw, app, steps, seed, dump);
+  if (dump != nullptr) {
+    std::fclose(dump);
+  }
+
+  std::printf("%s\n", failures == 0 ? "PASS" : "FAIL");
+  return failures == 0 ? 0 : 1;
+}